@@ -0,0 +1,210 @@
+/**
+ * \file audio_dma.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "audio_dma.hpp"
+
+#if PICO_ON_DEVICE
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/pwm.h>
+#include <hardware/timer.h>
+
+#include <string.h>
+
+namespace core::driver::audio
+{
+    namespace
+    {
+        /* read ring size in bits of one half */
+        const uint RING_BITS = 10;
+        static_assert((1u << RING_BITS) == DmaAudio::HALF * sizeof(uint32_t), "ring must cover one half");
+
+        /* dma timer fraction 1 / divider of clk_sys */
+        uint32_t divider_of(const uint32_t _sample_rate) { return (clock_get_hz(clk_sys) + _sample_rate / 2) / _sample_rate; }
+    }
+
+    DmaAudio::DmaAudio(const config_t &_config) :
+        config(_config),
+        clock_hz(clock_get_hz(clk_sys)),
+        divider(divider_of(_config.sample_rate)),
+        synthesizer({clock_hz / divider, _config.top, _config.wave})
+    {
+    }
+
+    void DmaAudio::initialize()
+    {
+        gpio_set_function(config.pin, GPIO_FUNC_PWM);
+        slice = pwm_gpio_to_slice_num(config.pin);
+        channel = pwm_gpio_to_channel(config.pin);
+
+        pwm_config pwm = pwm_get_default_config();
+        pwm_config_set_clkdiv_int(&pwm, 1);
+        pwm_config_set_wrap(&pwm, config.top);
+        pwm_init(slice, &pwm, true);
+        pwm_set_chan_level(slice, channel, 0);
+
+        dma_channel[0] = dma_claim_unused_channel(false);
+        dma_channel[1] = dma_claim_unused_channel(false);
+        timer = dma_claim_unused_timer(false);
+        if (dma_channel[0] < 0 || dma_channel[1] < 0 || timer < 0)
+        {
+            shutdown();
+            return;
+        }
+
+        dma_timer_set_fraction(static_cast<uint>(timer), 1, static_cast<uint16_t>(divider));
+
+        memset(buffer, 0, sizeof(buffer));
+
+        for (size_t half = 0; half < 2; ++half)
+        {
+            const uint dma = static_cast<uint>(dma_channel[half]);
+            dma_channel_config dma_config = dma_channel_get_default_config(dma);
+            channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_32);
+            channel_config_set_read_increment(&dma_config, true);
+            channel_config_set_write_increment(&dma_config, false);
+            channel_config_set_ring(&dma_config, false, RING_BITS);
+            channel_config_set_dreq(&dma_config, dma_get_timer_dreq(static_cast<uint>(timer)));
+            channel_config_set_chain_to(&dma_config, static_cast<uint>(dma_channel[half ^ 1]));
+            dma_channel_configure(dma, &dma_config, &pwm_hw->slice[slice].cc, buffer[half], HALF, false);
+        }
+
+        running = false;
+        refills = 0;
+    }
+
+    void DmaAudio::shutdown()
+    {
+        stop();
+
+        for (int &dma : dma_channel)
+        {
+            if (dma >= 0)
+            {
+                dma_channel_unclaim(static_cast<uint>(dma));
+                dma = -1;
+            }
+        }
+        if (timer >= 0)
+        {
+            dma_timer_unclaim(static_cast<uint>(timer));
+            timer = -1;
+        }
+
+        pwm_set_enabled(slice, false);
+    }
+
+    void DmaAudio::refill(const size_t _half)
+    {
+        /* the level goes into the 16 bit half of the compare register that belongs to the pin */
+        uint16_t *const levels = reinterpret_cast<uint16_t *>(buffer[_half]) + (channel == PWM_CHAN_B ? 1 : 0);
+        silent = synthesizer.render(levels, HALF, 2) ? 0 : silent + 1;
+        refills++;
+    }
+
+    void DmaAudio::play(const tone_t *const _tones, const size_t _count)
+    {
+        if (dma_channel[0] < 0)
+        {
+            return;
+        }
+
+        stop();
+        synthesizer.play(_tones, _count);
+        start();
+    }
+
+    void DmaAudio::play(const melody_view_t &_melody)
+    {
+        if (dma_channel[0] < 0)
+        {
+            return;
+        }
+
+        stop();
+        synthesizer.play(_melody);
+        start();
+    }
+
+    void DmaAudio::start()
+    {
+        silent = 0;
+
+        schedule.start([this](const size_t _half, const uint64_t) { refill(_half); });
+
+        dma_channel_set_read_addr(static_cast<uint>(dma_channel[0]), buffer[0], false);
+        dma_channel_set_read_addr(static_cast<uint>(dma_channel[1]), buffer[1], false);
+        started = time_us_64();
+        dma_channel_start(static_cast<uint>(dma_channel[0]));
+        running = true;
+    }
+
+    uint64_t DmaAudio::playing() const
+    {
+        /* the clock counts the laps, the busy channel and its count give the exact position */
+        const uint64_t sample = (time_us_64() - started) * clock_hz / (1000000ull * divider);
+        const bool busy[2] = {dma_channel_is_busy(static_cast<uint>(dma_channel[0])), dma_channel_is_busy(static_cast<uint>(dma_channel[1]))};
+        const size_t half = busy[1] ? 1 : 0;
+        const uint64_t position = HALF - dma_hw->ch[dma_channel[half]].transfer_count;
+
+        const uint64_t nearest = sample + HALF / 2 > position ? sample + HALF / 2 - position : 0;
+        uint64_t slot = nearest / HALF;
+        if (busy[0] != busy[1] && (slot & 1) != half)
+        {
+            /* clock and DMA disagree by a fraction of a half, the DMA knows its half */
+            slot = (nearest % HALF >= HALF / 2 || slot == 0) ? slot + 1 : slot - 1;
+        }
+        return slot;
+    }
+
+    void DmaAudio::chain(const bool _enable)
+    {
+        /* a channel chained to itself does not trigger another one */
+        for (size_t half = 0; half < 2; ++half)
+        {
+            const int target = dma_channel[_enable ? half ^ 1 : half];
+            hw_write_masked(&dma_hw->ch[dma_channel[half]].al1_ctrl,
+                            static_cast<uint32_t>(target) << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB,
+                            DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+        }
+    }
+
+    void DmaAudio::stop()
+    {
+        if (running)
+        {
+            /* an aborted channel must not start the other one */
+            chain(false);
+            dma_channel_abort(static_cast<uint>(dma_channel[0]));
+            dma_channel_abort(static_cast<uint>(dma_channel[1]));
+            chain(true);
+            running = false;
+        }
+
+        synthesizer.stop();
+        pwm_set_chan_level(slice, channel, 0);
+    }
+
+    void DmaAudio::perform()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        schedule.update(playing(), synthesizer, [this](const size_t _half, const uint64_t) { refill(_half); });
+
+        /* both halves silent, the end of the sequence has been played */
+        if (silent >= 2)
+        {
+            stop();
+        }
+    }
+}
+#endif
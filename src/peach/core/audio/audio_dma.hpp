@@ -0,0 +1,96 @@
+/**
+ * \file audio_dma.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_halves.hpp"
+#include "audio_synth.hpp"
+#include "audio_tone.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+#include <pico/types.h>
+
+namespace core::driver::audio
+{
+    /**
+     * \brief Sample based audio, a DMA timer streams levels into the pwm.
+     *
+     * The pwm runs at a carrier of clk_sys / (top + 1), two DMA channels
+     * chained to each other write one level per sample tick into its
+     * compare register, each channel owns one half of the buffer. The read
+     * ring of a channel wraps around its half, so a late refill repeats old
+     * samples but never reads beyond the buffer.
+     *
+     * perform() finds the slot the DMA plays from the time since start()
+     * and the position of the busy channel, and refills the other half for
+     * the next slot (HalfSchedule). The tone timing does not depend on how
+     * often it runs as long as it comes back within HALF samples; every
+     * half the DMA played stale counts as underrun, several laps between
+     * two calls too, and the sequence skips them to stay in time. The
+     * sample rate is clk_sys / round(clk_sys / sample_rate).
+     * The other channel of the pwm slice is held at 0.
+     */
+    class DmaAudio
+    {
+      public:
+        static const size_t HALF = 256;
+
+        struct config_t
+        {
+            uint pin;
+            uint32_t sample_rate;
+            uint16_t top;
+            const wave_t *wave;
+        };
+
+        explicit DmaAudio(const config_t &_config);
+
+        void initialize();
+        void perform();
+        void shutdown();
+
+        void play(const tone_t *const _tones, const size_t _count);
+        void play(const melody_view_t &_melody);
+        void stop();
+
+        /* still streaming, the end of a sequence plays after is_playing() went false */
+        bool is_active() const { return running; }
+        bool is_playing() const { return synthesizer.is_playing(); }
+        uint32_t get_refills() const { return refills; }
+        uint32_t get_underruns() const { return schedule.get_underruns(); }
+
+      protected:
+        void start();
+        uint64_t playing() const;
+        void refill(const size_t _half);
+        void chain(const bool _enable);
+
+        const config_t config;
+        const uint32_t clock_hz;
+        const uint32_t divider;
+        Synthesizer synthesizer;
+        HalfSchedule schedule{HALF};
+
+        uint slice = 0;
+        uint channel = 0;
+        int dma_channel[2] = {-1, -1};
+        int timer = -1;
+        bool running = false;
+        uint32_t silent = 0;
+        uint64_t started = 0;
+
+        uint32_t refills = 0;
+
+        /* each half is aligned to its size for the DMA read ring */
+        alignas(HALF * sizeof(uint32_t)) uint32_t buffer[2][HALF];
+    };
+}
+#endif
@@ -0,0 +1,79 @@
+/**
+ * \file audio_halves.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_synth.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    /**
+     * \brief Refill order of the two DMA halves, no hardware involved.
+     *
+     * The DMA plays slot 0, 1, 2, ... of _half samples each, slot k out of
+     * half k % 2. update() gets the slot the DMA plays now and refills the
+     * other half for the slot after it. Slots that started before their
+     * refill replay old content: each one counts as an underrun, however
+     * many laps the caller was late, and the synthesizer skips their
+     * samples. So every refill renders the samples that belong to its slot
+     * and the sequence stays on the time line of the DMA.
+     *
+     * DmaAudio takes the slot from the DMA, jitter::sample_based() from a
+     * virtual clock, both run the same refill code. REFILL is called as
+     * _refill(half, slot) and renders _half samples into the half.
+     */
+    class HalfSchedule
+    {
+      public:
+        explicit HalfSchedule(const size_t _half) :
+            half(_half)
+        {
+        }
+
+        /* play(): both halves are rendered before the DMA starts with slot 0 */
+        template <typename REFILL>
+        void start(REFILL _refill)
+        {
+            next = 2;
+            underruns = 0;
+            _refill(0, 0);
+            _refill(1, 1);
+        }
+
+        template <typename REFILL>
+        void update(const uint64_t _playing, Synthesizer &_synthesizer, REFILL _refill)
+        {
+            const uint64_t slot = _playing + 1;
+            if (slot < next)
+            {
+                /* the half after the playing one is already rendered */
+                return;
+            }
+
+            const uint64_t missed = slot - next;
+            if (missed)
+            {
+                underruns += static_cast<uint32_t>(missed);
+                _synthesizer.skip(missed * half);
+            }
+
+            _refill(static_cast<size_t>(slot % 2), slot);
+            next = slot + 1;
+        }
+
+        uint32_t get_underruns() const { return underruns; }
+
+      protected:
+        const size_t half;
+        uint64_t next = 2;
+        uint32_t underruns = 0;
+    };
+}
@@ -0,0 +1,326 @@
+/**
+ * \file audio_melody.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_note_table.hpp"
+#include "audio_tone.hpp"
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    namespace melody
+    {
+        /*
+            one note is 11 bits, least significant bit first:
+            - bits 0..6: 0 is a pause, otherwise midi note - note::LOWEST + 1
+            - bits 7..9: duration 1 / 2^n of a whole note, n = 0..5
+            - bit 10:    dotted, one and a half of the duration
+        */
+        static const size_t BITS = 11;
+        static const uint16_t MASK = (1u << BITS) - 1;
+        static const uint8_t DOTTED = 1u << 3;
+
+        constexpr size_t bytes(const size_t _notes) { return (_notes * BITS + 7) / 8; }
+
+        /* milliseconds of a note from the duration bits, pack() rejects what does not fit into tone_t */
+        constexpr uint32_t duration_of(const uint16_t _whole_ms, const uint8_t _length)
+        {
+            const uint32_t duration = _whole_ms >> (_length & 0x7);
+            return duration + ((_length & DOTTED) ? duration / 2 : 0);
+        }
+
+        constexpr std::array<uint16_t, note::COUNT> make_hertz()
+        {
+            std::array<uint16_t, note::COUNT> table{};
+            for (size_t i = 0; i < note::COUNT; ++i)
+            {
+                table[i] = static_cast<uint16_t>((note::millihertz(static_cast<uint8_t>(note::LOWEST + i)) + 500) / 1000);
+            }
+            return table;
+        }
+
+        constexpr std::array<uint16_t, note::COUNT> HERTZ = make_hertz();
+    }
+
+    /* a packed melody without its size in the type, what the synthesizer reads */
+    struct melody_view_t
+    {
+        const uint8_t *bits;
+        uint16_t count;
+        uint16_t whole_ms;
+        uint8_t volume;
+
+        /* decodes one note, no state besides the index */
+        constexpr tone_t at(const size_t _index) const
+        {
+            const size_t position = _index * melody::BITS;
+            const size_t byte = position / 8;
+            uint32_t word = bits[byte] | static_cast<uint32_t>(bits[byte + 1]) << 8;
+            word |= (position % 8 + melody::BITS > 16) ? static_cast<uint32_t>(bits[byte + 2]) << 16 : 0;
+            const uint16_t code = static_cast<uint16_t>((word >> (position % 8)) & melody::MASK);
+
+            const uint8_t pitch = code & 0x7f;
+            const uint8_t length = static_cast<uint8_t>(code >> 7);
+
+            return tone_t{pitch ? melody::HERTZ[pitch - 1] : static_cast<uint16_t>(0),
+                          static_cast<uint16_t>(melody::duration_of(whole_ms, length)),
+                          pitch ? volume : static_cast<uint8_t>(0)};
+        }
+    };
+
+    /**
+     * \brief A melody packed into 11 bits per note, built by melody::pack().
+     *
+     * A tone_t takes 6 bytes per note, the packed form less than 1.4. valid
+     * is false when the text could not be parsed, check it with a
+     * static_assert next to the definition.
+     */
+    template <size_t NOTES>
+    struct Melody
+    {
+        bool valid;
+        uint16_t whole_ms;
+        uint8_t volume;
+        uint8_t bits[melody::bytes(NOTES)];
+
+        constexpr melody_view_t view() const { return melody_view_t{bits, static_cast<uint16_t>(NOTES), whole_ms, volume}; }
+        static constexpr size_t size() { return NOTES; }
+    };
+
+    namespace melody
+    {
+        namespace parse
+        {
+            constexpr bool is_digit(const char _c) { return _c >= '0' && _c <= '9'; }
+            constexpr char lower(const char _c) { return (_c >= 'A' && _c <= 'Z') ? static_cast<char>(_c - 'A' + 'a') : _c; }
+
+            constexpr size_t skip(const char *const _text, size_t _at)
+            {
+                while (_text[_at] == ' ')
+                {
+                    _at++;
+                }
+                return _at;
+            }
+
+            constexpr uint32_t number(const char *const _text, size_t &_at)
+            {
+                uint32_t value = 0;
+                while (is_digit(_text[_at]))
+                {
+                    value = value * 10 + static_cast<uint32_t>(_text[_at++] - '0');
+                }
+                return value;
+            }
+
+            /* start of the note section, after the second ':' */
+            constexpr size_t notes(const char *const _text)
+            {
+                size_t at = 0;
+                for (int colon = 0; colon < 2; ++colon)
+                {
+                    while (_text[at] && _text[at] != ':')
+                    {
+                        at++;
+                    }
+                    at += _text[at] ? 1 : 0;
+                }
+                return at;
+            }
+
+            /* 2^n of a note length 1, 2, 4 ... 32, or 0xff */
+            constexpr uint8_t length_of(const uint32_t _duration)
+            {
+                for (uint8_t n = 0; n < 6; ++n)
+                {
+                    if (_duration == (1u << n))
+                    {
+                        return n;
+                    }
+                }
+                return 0xff;
+            }
+
+            constexpr int semitone_of(const char _letter)
+            {
+                switch (_letter)
+                {
+                    case 'c':
+                        return 0;
+                    case 'd':
+                        return 2;
+                    case 'e':
+                        return 4;
+                    case 'f':
+                        return 5;
+                    case 'g':
+                        return 7;
+                    case 'a':
+                        return 9;
+                    case 'b':
+                    case 'h':
+                        return 11;
+                    default:
+                        return -1;
+                }
+            }
+        }
+
+        /* number of notes of a ringtone text "name:d=4,o=5,b=120:8e5,p,..." */
+        constexpr size_t count(const char *const _text)
+        {
+            size_t at = parse::skip(_text, parse::notes(_text));
+            if (!_text[at])
+            {
+                return 0;
+            }
+
+            size_t result = 1;
+            for (; _text[at]; ++at)
+            {
+                result += _text[at] == ',' ? 1 : 0;
+            }
+            return result;
+        }
+
+        /**
+         * \brief Parses a ringtone (RTTTL) text, meant for compile time.
+         *
+         * Defaults d (duration), o (octave) and b (beats per minute) come
+         * from the second section, a note is [duration]letter[#][.][octave][.]
+         * with p for a pause. Notes outside note::LOWEST..HIGHEST, unknown
+         * letters, durations other than 1..32 and notes longer than the
+         * 65535 ms of a tone_t (a dotted whole below 6 bpm) make the
+         * result invalid.
+         */
+        template <size_t NOTES>
+        constexpr Melody<NOTES> pack(const char *const _text, const uint8_t _volume = FULL_VOLUME)
+        {
+            Melody<NOTES> result{};
+            result.volume = _volume;
+
+            uint32_t duration = 4;
+            uint32_t octave = 6;
+            uint32_t bpm = 63;
+
+            size_t at = 0;
+            while (_text[at] && _text[at] != ':')
+            {
+                at++;
+            }
+            at += _text[at] ? 1 : 0;
+
+            while (_text[at] && _text[at] != ':')
+            {
+                at = parse::skip(_text, at);
+                const char key = parse::lower(_text[at]);
+                if (_text[at] && _text[at + 1] == '=')
+                {
+                    at += 2;
+                    const uint32_t value = parse::number(_text, at);
+                    duration = key == 'd' ? value : duration;
+                    octave = key == 'o' ? value : octave;
+                    bpm = key == 'b' ? value : bpm;
+                }
+                while (_text[at] && _text[at] != ',' && _text[at] != ':')
+                {
+                    at++;
+                }
+                at += _text[at] == ',' ? 1 : 0;
+            }
+
+            if (_text[at] != ':' || bpm < 4 || parse::length_of(duration) == 0xff || count(_text) != NOTES)
+            {
+                return result;
+            }
+            result.whole_ms = static_cast<uint16_t>(240000 / bpm);
+            at++;
+
+            for (size_t i = 0; i < NOTES; ++i)
+            {
+                at = parse::skip(_text, at);
+
+                const uint32_t own = parse::is_digit(_text[at]) ? parse::number(_text, at) : duration;
+                uint8_t length = parse::length_of(own);
+
+                const char letter = parse::lower(_text[at++]);
+                const int semitone = parse::semitone_of(letter);
+                if (length == 0xff || (semitone < 0 && letter != 'p'))
+                {
+                    return result;
+                }
+
+                const bool sharp = _text[at] == '#';
+                at += sharp ? 1 : 0;
+                if (_text[at] == '.')
+                {
+                    length |= DOTTED;
+                    at++;
+                }
+                const uint32_t scale = parse::is_digit(_text[at]) ? parse::number(_text, at) : octave;
+                if (_text[at] == '.')
+                {
+                    length |= DOTTED;
+                    at++;
+                }
+
+                if (duration_of(result.whole_ms, length) > UINT16_MAX)
+                {
+                    return result;
+                }
+
+                at = parse::skip(_text, at);
+                if (_text[at] != (i + 1 < NOTES ? ',' : '\0'))
+                {
+                    return result;
+                }
+                at++;
+
+                uint32_t pitch = 0;
+                if (letter != 'p')
+                {
+                    const uint32_t midi = 12 * (scale + 1) + static_cast<uint32_t>(semitone) + (sharp ? 1 : 0);
+                    if (midi < note::LOWEST || midi > note::HIGHEST)
+                    {
+                        return result;
+                    }
+                    pitch = midi - note::LOWEST + 1;
+                }
+
+                const uint32_t code = pitch | static_cast<uint32_t>(length) << 7;
+                const size_t position = i * BITS;
+                for (size_t bit = 0; bit < BITS; ++bit)
+                {
+                    if (code & (1u << bit))
+                    {
+                        result.bits[(position + bit) / 8] = static_cast<uint8_t>(result.bits[(position + bit) / 8] | (1u << ((position + bit) % 8)));
+                    }
+                }
+            }
+
+            result.valid = true;
+            return result;
+        }
+
+        /* the plain tone table of a melody, what it would cost unpacked */
+        template <size_t NOTES>
+        constexpr std::array<tone_t, NOTES> unpack(const Melody<NOTES> &_melody)
+        {
+            std::array<tone_t, NOTES> tones{};
+            for (size_t i = 0; i < NOTES; ++i)
+            {
+                tones[i] = _melody.view().at(i);
+            }
+            return tones;
+        }
+    }
+}
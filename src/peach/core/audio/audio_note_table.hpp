@@ -0,0 +1,161 @@
+/**
+ * \file audio_note_table.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+#include <hardware/pwm.h>
+#endif
+
+namespace core::driver::audio
+{
+    /* clk_sys of the default pico sdk clock setup */
+    static const uint32_t DEFAULT_CLOCK = 125000000;
+
+    /* pwm frequency = clock / ((div_int + div_frac / 16) * (wrap + 1)) */
+    struct pwm_setting_t
+    {
+        uint8_t div_int;
+        uint8_t div_frac;
+        uint16_t wrap;
+        uint16_t level;
+    };
+
+    namespace pwm_setting
+    {
+        /**
+         * \brief Divider and wrap for a frequency in mHz, level for 50% duty.
+         *
+         * The smallest divider that lets the wrap fit 16 bit gives the finest
+         * wrap and so the best frequency resolution. Integer only, it builds
+         * the table and is what a frequency driven player would have to
+         * compute per note without it.
+         */
+        constexpr pwm_setting_t compute(const uint32_t _clock, const uint32_t _millihertz)
+        {
+            const uint64_t ticks = static_cast<uint64_t>(_clock) * 16 * 1000;
+            const uint64_t period = static_cast<uint64_t>(_millihertz) * 65536;
+
+            uint64_t divider = (ticks + period - 1) / period;
+            divider = divider < 16 ? 16 : (divider > 0xfff ? 0xfff : divider);
+
+            const uint64_t step = divider * _millihertz;
+            uint64_t wrap = (ticks + step / 2) / step;
+            wrap = wrap < 2 ? 2 : (wrap > 65536 ? 65536 : wrap);
+
+            return pwm_setting_t{static_cast<uint8_t>(divider >> 4),
+                                 static_cast<uint8_t>(divider & 0xf),
+                                 static_cast<uint16_t>(wrap - 1),
+                                 static_cast<uint16_t>(wrap / 2)};
+        }
+
+        constexpr uint32_t millihertz_of(const uint32_t _clock, const pwm_setting_t &_setting)
+        {
+            const uint64_t divider = static_cast<uint64_t>(_setting.div_int) * 16 + _setting.div_frac;
+            return static_cast<uint32_t>(static_cast<uint64_t>(_clock) * 16 * 1000 / (divider * (_setting.wrap + 1ull)));
+        }
+
+        /* compare level for a volume, 0 is silent and 0xff the 50% duty of the table entry */
+        constexpr uint16_t level_for(const pwm_setting_t &_setting, const uint8_t _volume)
+        {
+            return static_cast<uint16_t>(static_cast<uint32_t>(_setting.level) * _volume / 0xff);
+        }
+    }
+
+    /* equal tempered notes by midi number, A4 (69) is 440 Hz */
+    namespace note
+    {
+        static const uint8_t LOWEST = 36;   /* C2, 65.4 Hz */
+        static const uint8_t HIGHEST = 108; /* C8, 4186 Hz */
+        static const size_t COUNT = HIGHEST - LOWEST + 1;
+
+        static const uint8_t A4 = 69;
+
+        constexpr uint32_t millihertz(const uint8_t _note)
+        {
+            constexpr double SEMITONE = 1.0594630943592952646;
+            double frequency = 440.0;
+            for (int i = A4; i < _note; ++i)
+            {
+                frequency *= SEMITONE;
+            }
+            for (int i = A4; i > _note; --i)
+            {
+                frequency /= SEMITONE;
+            }
+            return static_cast<uint32_t>(frequency * 1000.0 + 0.5);
+        }
+    }
+
+    /**
+     * \brief Pwm settings of all notes, computed at compile time for CLOCK.
+     *
+     * of() is one indexed load instead of the 64 bit divisions of
+     * pwm_setting::compute(). max_error_ppm() is a constant expression, the
+     * default clock is checked right here to stay within 0.5% of the nominal
+     * frequencies, other clocks can be checked the same way.
+     */
+    template <uint32_t CLOCK = DEFAULT_CLOCK>
+    class NoteTable
+    {
+      public:
+        static constexpr uint32_t MAX_ERROR_PPM = 5000;
+
+        static constexpr const pwm_setting_t &of(const uint8_t _note) { return TABLE[clamp(_note) - note::LOWEST]; }
+
+        static constexpr uint32_t error_ppm(const uint8_t _note)
+        {
+            const uint64_t nominal = note::millihertz(_note);
+            const uint64_t actual = pwm_setting::millihertz_of(CLOCK, of(_note));
+            const uint64_t difference = actual > nominal ? actual - nominal : nominal - actual;
+            return static_cast<uint32_t>(difference * 1000000 / nominal);
+        }
+
+        static constexpr uint32_t max_error_ppm()
+        {
+            uint32_t result = 0;
+            for (size_t i = note::LOWEST; i <= note::HIGHEST; ++i)
+            {
+                const uint32_t error = error_ppm(static_cast<uint8_t>(i));
+                result = error > result ? error : result;
+            }
+            return result;
+        }
+
+      private:
+        static constexpr uint8_t clamp(const uint8_t _note) { return _note < note::LOWEST ? note::LOWEST : (_note > note::HIGHEST ? note::HIGHEST : _note); }
+
+        static constexpr std::array<pwm_setting_t, note::COUNT> generate()
+        {
+            std::array<pwm_setting_t, note::COUNT> table{};
+            for (size_t i = 0; i < note::COUNT; ++i)
+            {
+                table[i] = pwm_setting::compute(CLOCK, note::millihertz(static_cast<uint8_t>(note::LOWEST + i)));
+            }
+            return table;
+        }
+
+        static constexpr std::array<pwm_setting_t, note::COUNT> TABLE = generate();
+    };
+
+    static_assert(NoteTable<>::max_error_ppm() <= NoteTable<>::MAX_ERROR_PPM, "note frequency off by more than 0.5%");
+
+#if PICO_ON_DEVICE
+    /* fast path for a frequency driven player: register writes only, no division; no player in this tree uses it yet */
+    inline void apply(const uint _slice, const uint _channel, const pwm_setting_t &_setting, const uint8_t _volume)
+    {
+        pwm_set_clkdiv_int_frac(_slice, _setting.div_int, _setting.div_frac);
+        pwm_set_wrap(_slice, _setting.wrap);
+        pwm_set_chan_level(_slice, _channel, pwm_setting::level_for(_setting, _volume));
+    }
+#endif
+}
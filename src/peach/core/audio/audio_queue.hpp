@@ -0,0 +1,300 @@
+/**
+ * \file audio_queue.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_tone.hpp"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    enum class priority_t : uint8_t
+    {
+        AMBIENT,
+        NOTICE,
+        ALERT,
+    };
+
+    /*
+        what happens to a sound that is already playing or waiting:
+        - APPEND:  play it again afterwards
+        - DROP:    the new request is dropped
+        - REPLACE: waiting copies are dropped, a playing copy restarts
+    */
+    enum class coalesce_t : uint8_t
+    {
+        APPEND,
+        DROP,
+        REPLACE,
+    };
+
+    /* the tone table identifies the sound */
+    struct sound_t
+    {
+        const tone_t *tones;
+        uint16_t count;
+        priority_t priority;
+        coalesce_t coalesce;
+    };
+
+    struct queue_statistics_t
+    {
+        uint32_t submitted;
+        uint32_t played;
+        uint32_t dropped;
+        uint32_t coalesced;
+        uint32_t preempted;
+        uint32_t max_depth;
+    };
+
+    /**
+     * \brief Sound requests from any context, played by priority.
+     *
+     * The RP2040 has no compare and swap, so every producer context (main
+     * loop, an interrupt, core1, ...) gets its own single producer ring
+     * with SLOTS entries. submit() never blocks and never allocates, a full
+     * ring drops the request. perform() in the main loop moves requests
+     * into the waiting list, applies the coalesce policy and starts the
+     * waiting sound with the highest priority (oldest first). A higher
+     * priority preempts the playing sound, the preempted sound is dropped.
+     *
+     * PLAYER needs play(tones, count), stop() and is_active(), e.g. DmaAudio.
+     */
+    template <typename PLAYER, size_t SOURCES = 3, size_t SLOTS = 8>
+    class SoundQueue
+    {
+      public:
+        static const size_t WAITING = 8;
+
+        static_assert(SLOTS && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two");
+
+        explicit SoundQueue(PLAYER &_player) :
+            player(_player)
+        {
+        }
+
+        void initialize()
+        {
+            for (ring_t &ring : rings)
+            {
+                ring.head.store(0);
+                ring.tail.store(0);
+                ring.rejected.store(0);
+            }
+            waiting = 0;
+            playing = false;
+            arrival = 0;
+            statistics = queue_statistics_t{};
+        }
+
+        /* one producer per source, any core, any interrupt level; an unknown source is rejected */
+        bool submit(const size_t _source, const sound_t &_sound)
+        {
+            if (_source >= SOURCES)
+            {
+                return false;
+            }
+
+            ring_t &ring = rings[_source];
+            const uint32_t head = ring.head.load(std::memory_order_relaxed);
+            if (head - ring.tail.load(std::memory_order_acquire) == SLOTS)
+            {
+                ring.rejected.store(ring.rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            ring.slot[head % SLOTS] = _sound;
+            ring.head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /* the source checked at compile time */
+        template <size_t SOURCE>
+        bool submit(const sound_t &_sound)
+        {
+            static_assert(SOURCE < SOURCES, "no ring for this source");
+            return submit(SOURCE, _sound);
+        }
+
+        void perform()
+        {
+            const uint32_t depth = static_cast<uint32_t>(get_depth());
+            statistics.max_depth = depth > statistics.max_depth ? depth : statistics.max_depth;
+
+            for (ring_t &ring : rings)
+            {
+                uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+                while (tail != ring.head.load(std::memory_order_acquire))
+                {
+                    const sound_t sound = ring.slot[tail % SLOTS];
+                    ring.tail.store(++tail, std::memory_order_release);
+                    accept(sound);
+                }
+            }
+
+            if (playing && !player.is_active())
+            {
+                playing = false;
+                statistics.played++;
+            }
+
+            const size_t best = select();
+            if (best < waiting && (!playing || list[best].sound.priority > current.priority))
+            {
+                if (playing)
+                {
+                    player.stop();
+                    statistics.preempted++;
+                }
+                start(best);
+            }
+        }
+
+        bool is_idle() const { return !playing && get_depth() == 0; }
+
+        /* waiting and not yet collected requests */
+        size_t get_depth() const
+        {
+            size_t depth = waiting;
+            for (const ring_t &ring : rings)
+            {
+                depth += ring.head.load(std::memory_order_acquire) - ring.tail.load(std::memory_order_relaxed);
+            }
+            return depth;
+        }
+
+        queue_statistics_t get_statistics() const
+        {
+            queue_statistics_t result = statistics;
+            for (const ring_t &ring : rings)
+            {
+                result.dropped += ring.rejected.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+      protected:
+        struct ring_t
+        {
+            sound_t slot[SLOTS];
+            std::atomic<uint32_t> head{0};
+            std::atomic<uint32_t> tail{0};
+            std::atomic<uint32_t> rejected{0};
+        };
+
+        struct entry_t
+        {
+            sound_t sound;
+            uint32_t arrival;
+        };
+
+        void accept(const sound_t &_sound)
+        {
+            statistics.submitted++;
+            const bool is_playing = playing && current.tones == _sound.tones;
+
+            if (_sound.coalesce == coalesce_t::DROP && (is_playing || find(_sound.tones) < waiting))
+            {
+                statistics.coalesced++;
+                return;
+            }
+
+            if (_sound.coalesce == coalesce_t::REPLACE)
+            {
+                for (size_t i = find(_sound.tones); i < waiting; i = find(_sound.tones))
+                {
+                    remove(i);
+                    statistics.coalesced++;
+                }
+                if (is_playing)
+                {
+                    statistics.coalesced++;
+                    current = _sound;
+                    player.play(current.tones, current.count);
+                    return;
+                }
+            }
+
+            if (waiting == WAITING)
+            {
+                /* the newest of the lowest priority makes room for a more important sound */
+                size_t victim = 0;
+                for (size_t i = 1; i < waiting; ++i)
+                {
+                    victim = list[i].sound.priority <= list[victim].sound.priority ? i : victim;
+                }
+                if (list[victim].sound.priority >= _sound.priority)
+                {
+                    statistics.dropped++;
+                    return;
+                }
+                remove(victim);
+                statistics.dropped++;
+            }
+
+            list[waiting++] = entry_t{_sound, arrival++};
+        }
+
+        size_t find(const tone_t *const _tones) const
+        {
+            for (size_t i = 0; i < waiting; ++i)
+            {
+                if (list[i].sound.tones == _tones)
+                {
+                    return i;
+                }
+            }
+            return WAITING;
+        }
+
+        size_t select() const
+        {
+            size_t best = WAITING;
+            for (size_t i = 0; i < waiting; ++i)
+            {
+                if (best == WAITING || list[i].sound.priority > list[best].sound.priority ||
+                    (list[i].sound.priority == list[best].sound.priority && list[i].arrival - list[best].arrival > 0x80000000u))
+                {
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        void remove(const size_t _index)
+        {
+            for (size_t i = _index + 1; i < waiting; ++i)
+            {
+                list[i - 1] = list[i];
+            }
+            waiting--;
+        }
+
+        void start(const size_t _index)
+        {
+            current = list[_index].sound;
+            remove(_index);
+            playing = true;
+            player.play(current.tones, current.count);
+        }
+
+        PLAYER &player;
+        ring_t rings[SOURCES];
+
+        /* main loop owned */
+        entry_t list[WAITING];
+        size_t waiting = 0;
+        sound_t current = {};
+        bool playing = false;
+        uint32_t arrival = 0;
+        queue_statistics_t statistics = {};
+    };
+}
@@ -0,0 +1,268 @@
+/**
+ * \file audio_render.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "audio_render.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace core::driver::audio
+{
+    namespace
+    {
+        void put16(uint8_t *const _target, const uint32_t _value)
+        {
+            _target[0] = static_cast<uint8_t>(_value);
+            _target[1] = static_cast<uint8_t>(_value >> 8);
+        }
+
+        void put32(uint8_t *const _target, const uint32_t _value)
+        {
+            put16(_target, _value);
+            put16(_target + 2, _value >> 16);
+        }
+
+        template <typename SOURCE>
+        uint32_t milliseconds_of(const SOURCE &_source, const size_t _count)
+        {
+            uint32_t result = 0;
+            for (size_t i = 0; i < _count; ++i)
+            {
+                result += _source(i).duration_ms;
+            }
+            return result;
+        }
+
+        /* xorshift, the same cadence for the same seed */
+        uint32_t next(uint32_t &_state)
+        {
+            _state ^= _state << 13;
+            _state ^= _state >> 17;
+            _state ^= _state << 5;
+            return _state;
+        }
+
+        uint64_t interval_of(const jitter::cadence_t &_cadence, uint32_t &_state)
+        {
+            const int64_t offset = _cadence.jitter_us ? static_cast<int64_t>(next(_state) % (2 * _cadence.jitter_us + 1)) - _cadence.jitter_us : 0;
+            const int64_t interval = static_cast<int64_t>(_cadence.period_us) + offset;
+            return interval > 0 ? static_cast<uint64_t>(interval) : 1;
+        }
+
+        void add(jitter::drift_t &_drift, uint64_t &_sum, const uint64_t _actual_us, const uint64_t _nominal_us)
+        {
+            const uint32_t drift = static_cast<uint32_t>(_actual_us > _nominal_us ? _actual_us - _nominal_us : _nominal_us - _actual_us);
+            _drift.max_us = drift > _drift.max_us ? drift : _drift.max_us;
+            _drift.notes++;
+            _sum += drift;
+        }
+    }
+
+    namespace wav
+    {
+        void header(uint8_t *const _target, const uint32_t _sample_rate, const uint32_t _samples)
+        {
+            const uint32_t data = _samples * 2;
+
+            memcpy(&_target[0], "RIFF", 4);
+            put32(&_target[4], 36 + data);
+            memcpy(&_target[8], "WAVEfmt ", 8);
+            put32(&_target[16], 16);
+            put16(&_target[20], 1);
+            put16(&_target[22], 1);
+            put32(&_target[24], _sample_rate);
+            put32(&_target[28], _sample_rate * 2);
+            put16(&_target[32], 2);
+            put16(&_target[34], 16);
+            memcpy(&_target[36], "data", 4);
+            put32(&_target[40], data);
+        }
+    }
+
+    Recorder::Recorder(const Synthesizer::config_t &_config) :
+        synthesizer(_config)
+    {
+    }
+
+    size_t Recorder::record(const tone_t *const _tones, const size_t _count, write_t _write)
+    {
+        synthesizer.play(_tones, _count);
+        return run(milliseconds_of([_tones](const size_t _index) { return _tones[_index]; }, _count), _write);
+    }
+
+    size_t Recorder::record(const melody_view_t &_melody, write_t _write)
+    {
+        synthesizer.play(_melody);
+        return run(milliseconds_of([&_melody](const size_t _index) { return _melody.at(_index); }, _melody.count), _write);
+    }
+
+    size_t Recorder::run(const uint32_t _milliseconds, write_t _write)
+    {
+        const uint32_t rate = synthesizer.get_sample_rate();
+        const uint32_t top = synthesizer.get_top();
+        const uint32_t length = static_cast<uint32_t>(static_cast<uint64_t>(_milliseconds) * rate / 1000);
+
+        checksum_init(&crc, CHECKSUM_STREAM_CRC, 0);
+        samples = 0;
+        notes = 0;
+
+        if (_write)
+        {
+            uint8_t header[wav::HEADER];
+            wav::header(header, rate, length);
+            _write(header, sizeof(header));
+        }
+
+        uint16_t levels[BLOCK];
+        uint8_t pcm[BLOCK * 2];
+        size_t current = SIZE_MAX;
+
+        while (synthesizer.is_playing())
+        {
+            if (synthesizer.get_index() != current)
+            {
+                current = synthesizer.get_index();
+                const tone_t tone = synthesizer.get_tone();
+                if (notes < MAX_NOTES)
+                {
+                    onsets[notes] = onset_t{static_cast<uint32_t>(synthesizer.get_note_start()), tone.frequency, tone.duration_ms, tone.volume};
+                }
+                notes++;
+            }
+
+            /* blocks end at note boundaries, every onset is seen */
+            const uint64_t left = synthesizer.get_note_end() - synthesizer.get_position();
+            const size_t count = synthesizer.render(levels, left < BLOCK ? static_cast<size_t>(left) : BLOCK);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                put16(&pcm[i * 2], static_cast<uint32_t>(levels[i]) * 0xffff / top - 0x8000);
+            }
+            const chunk_t chunk = {pcm, count * 2};
+            checksum_update(&crc, &chunk);
+            samples += count;
+
+            if (_write)
+            {
+                _write(pcm, count * 2);
+            }
+        }
+
+        return samples;
+    }
+
+    void Recorder::log(write_t _write) const
+    {
+        const uint32_t rate = synthesizer.get_sample_rate();
+        const size_t count = notes < MAX_NOTES ? notes : MAX_NOTES;
+
+        char line[64];
+        for (size_t i = 0; i < count; ++i)
+        {
+            const onset_t &onset = onsets[i];
+            const int size = snprintf(line, sizeof(line), "%u,%lu,%lu,%u,%u,%u\n",
+                                      static_cast<unsigned>(i),
+                                      static_cast<unsigned long>(onset.sample),
+                                      static_cast<unsigned long>(static_cast<uint64_t>(onset.sample) * 1000 / rate),
+                                      onset.frequency,
+                                      onset.duration_ms,
+                                      onset.volume);
+            _write(reinterpret_cast<const uint8_t *>(line), static_cast<size_t>(size));
+        }
+    }
+
+    namespace jitter
+    {
+        drift_t loop_driven(const tone_t *const _tones, const size_t _count, const cadence_t &_cadence)
+        {
+            drift_t result = {};
+            uint64_t sum = 0;
+            uint32_t state = _cadence.seed ? _cadence.seed : 1;
+
+            /* the first note starts with the first perform() */
+            uint64_t now = 0;
+            uint64_t start = 0;
+            uint64_t nominal = 0;
+            size_t index = 0;
+            add(result, sum, 0, 0);
+
+            while (index < _count)
+            {
+                now += interval_of(_cadence, state);
+                while (index < _count && now - start >= _tones[index].duration_ms * 1000ull)
+                {
+                    nominal += _tones[index].duration_ms * 1000ull;
+                    start = now;
+                    if (++index < _count && _tones[index].duration_ms)
+                    {
+                        add(result, sum, now, nominal);
+                    }
+                }
+            }
+
+            result.mean_us = static_cast<uint32_t>(sum / result.notes);
+            return result;
+        }
+
+        drift_t sample_based(const tone_t *const _tones, const size_t _count, const uint32_t _sample_rate, const size_t _half, const cadence_t &_cadence)
+        {
+            drift_t result = {};
+            uint64_t sum = 0;
+            uint32_t state = _cadence.seed ? _cadence.seed : 1;
+
+            const uint64_t length = static_cast<uint64_t>(milliseconds_of([_tones](const size_t _index) { return _tones[_index]; }, _count)) * _sample_rate / 1000;
+            const uint64_t halves = (length + _half - 1) / _half;
+            const auto time_of = [_sample_rate](const uint64_t _samples) { return _samples * 1000000 / _sample_rate; };
+
+            Synthesizer synthesizer({_sample_rate, 255, &wave::SQUARE});
+            HalfSchedule schedule(_half);
+
+            size_t index = 0;
+            uint64_t elapsed_ms = 0;
+
+            /* what DmaAudio::refill() does, plus the onsets the slot brings */
+            const auto refill = [&](const size_t, const uint64_t _slot)
+            {
+                uint16_t levels[Recorder::BLOCK];
+                for (size_t done = 0; done < _half; done += Recorder::BLOCK)
+                {
+                    synthesizer.render(levels, _half - done < Recorder::BLOCK ? _half - done : Recorder::BLOCK);
+                }
+
+                while (index < _count && elapsed_ms * _sample_rate / 1000 < (_slot + 1) * _half)
+                {
+                    const uint64_t onset = elapsed_ms * _sample_rate / 1000;
+                    if (_tones[index].duration_ms)
+                    {
+                        add(result, sum, time_of(onset > _slot * _half ? onset : _slot * _half), time_of(onset));
+                    }
+                    elapsed_ms += _tones[index++].duration_ms;
+                }
+            };
+
+            synthesizer.play(_tones, _count);
+            schedule.start(refill);
+
+            /* perform() on the virtual clock, the first call when the DMA starts */
+            for (uint64_t now = 0; now * _sample_rate / 1000000 / _half < halves; now += interval_of(_cadence, state))
+            {
+                schedule.update(now * _sample_rate / 1000000 / _half, synthesizer, refill);
+            }
+
+            /* the DMA reached the end, onsets of slots no perform() refilled start after it */
+            if (halves)
+            {
+                schedule.update(halves - 1, synthesizer, refill);
+            }
+
+            result.underruns = schedule.get_underruns();
+            result.mean_us = result.notes ? static_cast<uint32_t>(sum / result.notes) : 0;
+            return result;
+        }
+    }
+}
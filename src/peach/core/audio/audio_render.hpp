@@ -0,0 +1,112 @@
+/**
+ * \file audio_render.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_halves.hpp"
+#include "audio_melody.hpp"
+#include "audio_synth.hpp"
+#include "audio_tone.hpp"
+#include "checksum_stream.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    /* where a note starts in the rendered stream */
+    struct onset_t
+    {
+        uint32_t sample;
+        uint16_t frequency;
+        uint16_t duration_ms;
+        uint8_t volume;
+    };
+
+    namespace wav
+    {
+        static const size_t HEADER = 44;
+
+        /* 16 bit signed mono PCM */
+        void header(uint8_t *const _target, const uint32_t _sample_rate, const uint32_t _samples);
+    }
+
+    /**
+     * \brief Renders a sequence offline into a WAV stream and a note log.
+     *
+     * The same synthesizer that feeds the DMA renders the whole sequence
+     * at once, no pwm and no timing involved. The stream goes to a write
+     * handler (a file on the host), its CRC and the note onsets stay for
+     * comparing against known good values. log() writes one csv line per
+     * note: index, sample, ms, frequency, duration_ms, volume.
+     */
+    class Recorder
+    {
+      public:
+        static const size_t BLOCK = 256;
+        static const size_t MAX_NOTES = 128;
+
+        typedef void (*write_t)(const uint8_t *const _data, const size_t _size);
+
+        explicit Recorder(const Synthesizer::config_t &_config);
+
+        /* \return number of rendered samples */
+        size_t record(const tone_t *const _tones, const size_t _count, write_t _write = nullptr);
+        size_t record(const melody_view_t &_melody, write_t _write = nullptr);
+
+        void log(write_t _write) const;
+
+        uint16_t get_crc() const { return checksum_finalize(&crc); }
+        size_t get_samples() const { return samples; }
+        /* notes with a length, zero length notes do not start */
+        size_t get_notes() const { return notes; }
+        const onset_t &get_onset(const size_t _index) const { return onsets[_index < MAX_NOTES ? _index : MAX_NOTES - 1]; }
+
+      protected:
+        size_t run(const uint32_t _milliseconds, write_t _write);
+
+        Synthesizer synthesizer;
+        checksum_context_t crc = {};
+        size_t samples = 0;
+        size_t notes = 0;
+        onset_t onsets[MAX_NOTES] = {};
+    };
+
+    /**
+     * \brief How far note onsets drift when perform() does not come in time.
+     *
+     * perform() is called every period_us, randomly off by up to
+     * jitter_us, on a virtual clock. loop_driven() switches notes in
+     * perform() when their time is up, like a frequency driven pwm does.
+     * sample_based() runs the refill code of DmaAudio (HalfSchedule and the
+     * synthesizer) with the slot of the DMA taken from the virtual clock.
+     * A slot that is not refilled in time replays old content (underrun)
+     * and is skipped by the sequence, which keeps its timing: an onset in
+     * a skipped slot is heard at the start of the next refilled one.
+     */
+    namespace jitter
+    {
+        struct cadence_t
+        {
+            uint32_t period_us;
+            uint32_t jitter_us;
+            uint32_t seed;
+        };
+
+        struct drift_t
+        {
+            uint32_t notes;
+            uint32_t max_us;
+            uint32_t mean_us;
+            uint32_t underruns;
+        };
+
+        drift_t loop_driven(const tone_t *const _tones, const size_t _count, const cadence_t &_cadence);
+        drift_t sample_based(const tone_t *const _tones, const size_t _count, const uint32_t _sample_rate, const size_t _half, const cadence_t &_cadence);
+    }
+}
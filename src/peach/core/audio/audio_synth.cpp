@@ -0,0 +1,129 @@
+/**
+ * \file audio_synth.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "audio_synth.hpp"
+
+namespace core::driver::audio
+{
+    Synthesizer::Synthesizer(const config_t &_config) :
+        config(_config)
+    {
+    }
+
+    void Synthesizer::play(const tone_t *const _tones, const size_t _count)
+    {
+        tones = _tones;
+        count = _count;
+        start();
+    }
+
+    void Synthesizer::play(const melody_view_t &_melody)
+    {
+        tones = nullptr;
+        melody = _melody;
+        count = _melody.count;
+        start();
+    }
+
+    void Synthesizer::start()
+    {
+        index = 0;
+        position = 0;
+        note_start = 0;
+        note_end = 0;
+        elapsed_ms = 0;
+        phase = 0;
+        load();
+    }
+
+    void Synthesizer::stop()
+    {
+        index = count;
+        scale = 0;
+    }
+
+    void Synthesizer::load()
+    {
+        /* zero length notes are skipped, the next note starts where the last one ended */
+        while (index < count)
+        {
+            const tone_t tone = get_tone();
+            elapsed_ms += tone.duration_ms;
+            note_end = static_cast<uint64_t>(elapsed_ms) * config.sample_rate / 1000;
+
+            if (note_end > position)
+            {
+                note_start = position;
+                /* frequency / sample_rate of a full turn of the 32 bit phase */
+                increment = static_cast<uint32_t>((static_cast<uint64_t>(tone.frequency) << 32) / config.sample_rate);
+                scale = tone.frequency ? static_cast<uint32_t>(config.top) * tone.volume / FULL_VOLUME : 0;
+                return;
+            }
+            index++;
+        }
+        scale = 0;
+    }
+
+    size_t Synthesizer::render(uint16_t *const _target, const size_t _count, const size_t _stride)
+    {
+        size_t rendered = 0;
+        size_t i = 0;
+
+        while (i < _count && index < count)
+        {
+            const uint64_t left = note_end - position;
+            const size_t run = left < _count - i ? static_cast<size_t>(left) : _count - i;
+
+            const wave_t &wave = *config.wave;
+            for (size_t n = 0; n < run; ++n)
+            {
+                _target[(i + n) * _stride] = static_cast<uint16_t>((wave[phase >> 24] * scale) >> 8);
+                phase += increment;
+            }
+
+            i += run;
+            rendered += run;
+            position += run;
+
+            if (position == note_end)
+            {
+                index++;
+                load();
+            }
+        }
+
+        for (; i < _count; ++i)
+        {
+            _target[i * _stride] = 0;
+        }
+        return rendered;
+    }
+
+    uint64_t Synthesizer::skip(const uint64_t _count)
+    {
+        uint64_t skipped = 0;
+
+        while (skipped < _count && index < count)
+        {
+            const uint64_t left = note_end - position;
+            const uint64_t run = left < _count - skipped ? left : _count - skipped;
+
+            /* the phase wraps like it does sample by sample */
+            phase += static_cast<uint32_t>(run * increment);
+            skipped += run;
+            position += run;
+
+            if (position == note_end)
+            {
+                index++;
+                load();
+            }
+        }
+        return skipped;
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * \file audio_synth.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_melody.hpp"
+#include "audio_tone.hpp"
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    static const size_t WAVE_SIZE = 256;
+
+    typedef std::array<uint8_t, WAVE_SIZE> wave_t;
+
+    namespace wave
+    {
+        constexpr double PI = 3.14159265358979323846;
+
+        /* Taylor series, good to 1e-6 on [-pi, pi] */
+        constexpr double sine(const double _x)
+        {
+            double term = _x;
+            double sum = _x;
+            for (int n = 1; n < 12; ++n)
+            {
+                term *= -_x * _x / ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr wave_t make_sine()
+        {
+            wave_t table{};
+            for (size_t i = 0; i < WAVE_SIZE; ++i)
+            {
+                const double x = 2 * PI * static_cast<double>(i) / WAVE_SIZE - PI;
+                /* -sine(x - pi) == sine(x), the table starts at phase 0 */
+                table[i] = static_cast<uint8_t>(127.5 - 127.5 * sine(x) + 0.5);
+            }
+            return table;
+        }
+
+        constexpr wave_t make_square()
+        {
+            wave_t table{};
+            for (size_t i = 0; i < WAVE_SIZE; ++i)
+            {
+                table[i] = i < WAVE_SIZE / 2 ? 0xff : 0x00;
+            }
+            return table;
+        }
+
+        /* the buzzer sound of the frequency driven pwm */
+        constexpr wave_t SQUARE = make_square();
+        constexpr wave_t SINE = make_sine();
+    }
+
+    /**
+     * \brief Renders a tone sequence into pwm compare levels.
+     *
+     * A phase accumulator walks through the wavetable, so any frequency
+     * works at any sample rate. Note boundaries are computed from the
+     * summed up durations, the sequence length in samples is exact and does
+     * not drift with the number of notes. After the sequence the output is
+     * silent (level 0).
+     *
+     * A packed melody is decoded one note at a time when the note starts,
+     * it never gets unpacked into RAM.
+     *
+     * The same code feeds the DMA buffers on the device and renders into
+     * plain memory on the host.
+     */
+    class Synthesizer
+    {
+      public:
+        struct config_t
+        {
+            uint32_t sample_rate;
+            uint16_t top;
+            const wave_t *wave;
+        };
+
+        explicit Synthesizer(const config_t &_config);
+
+        void play(const tone_t *const _tones, const size_t _count);
+        void play(const melody_view_t &_melody);
+        void stop();
+
+        /**
+         * \brief Writes _count levels to _target[0], _target[_stride], ...
+         *
+         * \return number of rendered samples that belong to the sequence
+         */
+        size_t render(uint16_t *const _target, const size_t _count, const size_t _stride = 1);
+
+        /* moves on by _count samples as if they were rendered, \return samples of the sequence */
+        uint64_t skip(const uint64_t _count);
+
+        bool is_playing() const { return index < count; }
+        uint32_t get_sample_rate() const { return config.sample_rate; }
+        uint16_t get_top() const { return config.top; }
+        uint64_t get_position() const { return position; }
+
+        /* the note being rendered, only while is_playing() */
+        size_t get_index() const { return index; }
+        tone_t get_tone() const { return tones ? tones[index] : melody.at(index); }
+        uint64_t get_note_start() const { return note_start; }
+        uint64_t get_note_end() const { return note_end; }
+
+      protected:
+        void start();
+        void load();
+
+        const config_t config;
+
+        const tone_t *tones = nullptr;
+        melody_view_t melody = {};
+        size_t count = 0;
+        size_t index = 0;
+
+        uint64_t position = 0;
+        uint64_t note_start = 0;
+        uint64_t note_end = 0;
+        uint32_t elapsed_ms = 0;
+
+        uint32_t phase = 0;
+        uint32_t increment = 0;
+        uint32_t scale = 0;
+    };
+}
@@ -0,0 +1,29 @@
+/**
+ * \file audio_theme.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "audio_melody.hpp"
+
+namespace core::driver::audio::theme
+{
+    /* readable sources, only the packed melodies below end up in flash */
+    constexpr char IMPERIAL_MARCH_TEXT[] =
+        "imperial:d=4,o=5,b=100:e,e,e,8c,16p,16g,e,8c,16p,16g,e,p,b,b,b,8c6,16p,16g,d#,8c,16p,16g,e,8p,"
+        "e6,8e,16p,16e,e6,8d#6,16p,16d6,16c#6,16c6,16c#6,8p,8f,c#6,8c6,16p,16b,16a#,16a,16a#,8p,8e,g,8e,16p,16g,b,8g,16p,16b,2e6";
+    constexpr char ODE_TO_JOY_TEXT[] =
+        "ode:d=4,o=5,b=120:e,e,f,g,g,f,e,d,c,c,d,e,e.,8d,2d,e,e,f,g,g,f,e,d,c,c,d,e,d.,8c,2c";
+    constexpr char FANFARE_TEXT[] =
+        "fanfare:d=16,o=6,b=140:c,p,c,p,c,p,4c,4g#5,4a#5,c,8p,a#5,2c";
+
+    constexpr auto IMPERIAL_MARCH = melody::pack<melody::count(IMPERIAL_MARCH_TEXT)>(IMPERIAL_MARCH_TEXT);
+    constexpr auto ODE_TO_JOY = melody::pack<melody::count(ODE_TO_JOY_TEXT)>(ODE_TO_JOY_TEXT);
+    constexpr auto FANFARE = melody::pack<melody::count(FANFARE_TEXT)>(FANFARE_TEXT);
+
+    static_assert(IMPERIAL_MARCH.valid && ODE_TO_JOY.valid && FANFARE.valid, "theme does not parse");
+}
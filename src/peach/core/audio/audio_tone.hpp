@@ -0,0 +1,25 @@
+/**
+ * \file audio_tone.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::audio
+{
+    static const uint8_t FULL_VOLUME = 0xff;
+
+    /* one note of a sequence, frequency 0 is a pause */
+    struct tone_t
+    {
+        uint16_t frequency;
+        uint16_t duration_ms;
+        uint8_t volume;
+    };
+}
@@ -0,0 +1,176 @@
+/**
+ * \file checksum_backend.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "checksum_backend.hpp"
+
+#include "checksum_engine.hpp"
+
+#if PICO_ON_DEVICE
+#include <hardware/dma.h>
+#endif
+
+namespace core::checksum
+{
+    uint16_t SoftwareBackend::crc(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        return checksum_engine_crc(_chunk, _crc);
+    }
+
+    uint16_t SoftwareBackend::crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        return checksum_engine_crc_reflected(_chunk, _crc);
+    }
+
+    bool SoftwareBackend::start_crc(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        value = crc(_chunk, _crc);
+        return true;
+    }
+
+    bool SoftwareBackend::start_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        value = crc_reflected(_chunk, _crc);
+        return true;
+    }
+
+#if PICO_ON_DEVICE
+    namespace
+    {
+        /* sniffer calculation modes, see RP2040 datasheet SNIFF_CTRL.CALC */
+        const uint SNIFF_CRC16_CCITT = 0x2;
+        const uint SNIFF_CRC16_CCITT_REVERSED_DATA = 0x3;
+
+        uint16_t reverse(uint16_t _value)
+        {
+            _value = static_cast<uint16_t>(((_value & 0x5555) << 1) | ((_value >> 1) & 0x5555));
+            _value = static_cast<uint16_t>(((_value & 0x3333) << 2) | ((_value >> 2) & 0x3333));
+            _value = static_cast<uint16_t>(((_value & 0x0f0f) << 4) | ((_value >> 4) & 0x0f0f));
+            return static_cast<uint16_t>((_value << 8) | (_value >> 8));
+        }
+    }
+
+    void DmaBackend::initialize()
+    {
+        channel = dma_claim_unused_channel(false);
+    }
+
+    void DmaBackend::shutdown()
+    {
+        if (channel >= 0)
+        {
+            dma_channel_abort(static_cast<uint>(channel));
+            dma_sniffer_disable();
+            dma_channel_unclaim(static_cast<uint>(channel));
+            channel = -1;
+        }
+        sniffing = false;
+    }
+
+    bool DmaBackend::is_idle()
+    {
+        if (is_busy())
+        {
+            return false;
+        }
+
+        /* collect a finished but unread transfer so the sniffer is free again */
+        result();
+        return true;
+    }
+
+    bool DmaBackend::start(const chunk_t *const _chunk, const uint16_t _seed, const bool _reflected)
+    {
+        const uint dma = static_cast<uint>(channel);
+
+        dma_channel_config config = dma_channel_get_default_config(dma);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+        channel_config_set_read_increment(&config, true);
+        channel_config_set_write_increment(&config, false);
+        channel_config_set_sniff_enable(&config, true);
+
+        /*
+            the reflected crc is the normal crc over bit reversed data with a
+            bit reversed register, seed and result are mirrored around it
+        */
+        reflected = _reflected;
+        dma_hw->sniff_data = reflected ? reverse(_seed) : _seed;
+        dma_sniffer_enable(dma, reflected ? SNIFF_CRC16_CCITT_REVERSED_DATA : SNIFF_CRC16_CCITT, true);
+
+        dma_channel_configure(dma, &config, &sink, _chunk->space, static_cast<uint>(_chunk->size), true);
+        sniffing = true;
+
+        return true;
+    }
+
+    bool DmaBackend::is_busy()
+    {
+        return sniffing && dma_channel_is_busy(static_cast<uint>(channel));
+    }
+
+    uint16_t DmaBackend::result()
+    {
+        if (sniffing)
+        {
+            dma_channel_wait_for_finish_blocking(static_cast<uint>(channel));
+            const uint16_t sniffed = static_cast<uint16_t>(dma_hw->sniff_data);
+            dma_sniffer_disable();
+            sniffing = false;
+            value = reflected ? reverse(sniffed) : sniffed;
+        }
+        return value;
+    }
+
+    bool DmaBackend::start_crc(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        if (!is_idle())
+        {
+            return false;
+        }
+
+        if (_chunk->size < DMA_THRESHOLD || channel < 0)
+        {
+            value = checksum_engine_crc(_chunk, _crc);
+            return true;
+        }
+        return start(_chunk, _crc, false);
+    }
+
+    bool DmaBackend::start_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        if (!is_idle())
+        {
+            return false;
+        }
+
+        if (_chunk->size < DMA_THRESHOLD || channel < 0)
+        {
+            value = checksum_engine_crc_reflected(_chunk, _crc);
+            return true;
+        }
+        return start(_chunk, _crc, true);
+    }
+
+    uint16_t DmaBackend::crc(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        if (!start_crc(_chunk, _crc))
+        {
+            return checksum_engine_crc(_chunk, _crc);
+        }
+        return result();
+    }
+
+    uint16_t DmaBackend::crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+    {
+        if (!start_crc_reflected(_chunk, _crc))
+        {
+            return checksum_engine_crc_reflected(_chunk, _crc);
+        }
+        return result();
+    }
+#endif
+}
@@ -0,0 +1,106 @@
+/**
+ * \file checksum_backend.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::checksum
+{
+    /**
+     * \brief CRC16 calculation backend.
+     *
+     * Results are identical to checksum_crc and checksum_crc_reflected. The
+     * start/is_busy/result triple allows to run a long calculation in the
+     * background, backends without hardware support finish inside start.
+     */
+    class BackendInterface
+    {
+      public:
+        virtual ~BackendInterface() = default;
+
+        virtual void initialize() = 0;
+        virtual void shutdown() = 0;
+
+        virtual uint16_t crc(const chunk_t *const _chunk, const uint16_t _crc) = 0;
+        virtual uint16_t crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) = 0;
+
+        virtual bool start_crc(const chunk_t *const _chunk, const uint16_t _crc) = 0;
+        virtual bool start_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) = 0;
+        virtual bool is_busy() = 0;
+        virtual uint16_t result() = 0;
+    };
+
+    class SoftwareBackend : public BackendInterface
+    {
+      public:
+        void initialize() override {}
+        void shutdown() override {}
+
+        uint16_t crc(const chunk_t *const _chunk, const uint16_t _crc) override;
+        uint16_t crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) override;
+
+        bool start_crc(const chunk_t *const _chunk, const uint16_t _crc) override;
+        bool start_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) override;
+        bool is_busy() override { return false; }
+        uint16_t result() override { return value; }
+
+      private:
+        uint16_t value = 0;
+    };
+
+#if PICO_ON_DEVICE
+    /**
+     * \brief RP2040 DMA sniffer backend.
+     *
+     * Chunks from DMA_THRESHOLD bytes on are streamed by a claimed DMA channel
+     * into a dummy sink while the sniffer accumulates the CRC, smaller chunks
+     * are cheaper in software. The sniffer exists once per chip, only one
+     * instance may be initialized at a time.
+     */
+    class DmaBackend : public BackendInterface
+    {
+      public:
+        static const size_t DMA_THRESHOLD = 64;
+
+        void initialize() override;
+        void shutdown() override;
+
+        uint16_t crc(const chunk_t *const _chunk, const uint16_t _crc) override;
+        uint16_t crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) override;
+
+        bool start_crc(const chunk_t *const _chunk, const uint16_t _crc) override;
+        bool start_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc) override;
+        bool is_busy() override;
+        uint16_t result() override;
+
+      private:
+        bool is_idle();
+        bool start(const chunk_t *const _chunk, const uint16_t _seed, const bool _reflected);
+
+        int channel = -1;
+        bool reflected = false;
+        bool sniffing = false;
+        uint16_t value = 0;
+        uint8_t sink = 0;
+    };
+
+    namespace backend
+    {
+        using Variant = DmaBackend;
+    }
+#else
+    namespace backend
+    {
+        using Variant = SoftwareBackend;
+    }
+#endif
+}
@@ -0,0 +1,139 @@
+/**
+ * \file checksum_engine.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "checksum_engine.hpp"
+
+#include "checksum.hpp"
+
+namespace
+{
+    using namespace core::checksum::engine;
+
+    constexpr table_t<1> TABLE = generate_table<1>();
+    constexpr table_t<1> TABLE_REFLECTED = generate_table_reflected<1>();
+
+    constexpr table_t<4> SLICE4 = generate_table<4>();
+    constexpr table_t<4> SLICE4_REFLECTED = generate_table_reflected<4>();
+
+    inline uint16_t update(const uint8_t _value, const uint16_t _crc)
+    {
+        return static_cast<uint16_t>((_crc << 8) ^ TABLE.slice[0][((_crc >> 8) ^ _value) & 0xff]);
+    }
+
+    inline uint16_t update_reflected(const uint8_t _value, const uint16_t _crc)
+    {
+        return static_cast<uint16_t>((_crc >> 8) ^ TABLE_REFLECTED.slice[0][(_crc ^ _value) & 0xff]);
+    }
+}
+
+uint16_t checksum_crc_byte_table(const uint8_t _value, const uint16_t _crc)
+{
+    return update(_value, _crc);
+}
+
+uint16_t checksum_crc_table(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    const uint8_t *data = _chunk->space;
+
+    for (size_t i = 0; i < _chunk->size; ++i)
+    {
+        crc = update(data[i], crc);
+    }
+
+    return crc;
+}
+
+uint16_t checksum_crc_reflected_table(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    const uint8_t *data = _chunk->space;
+
+    for (size_t i = 0; i < _chunk->size; ++i)
+    {
+        crc = update_reflected(data[i], crc);
+    }
+
+    return crc;
+}
+
+uint16_t checksum_crc_slice4(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    const uint8_t *data = _chunk->space;
+    size_t size = _chunk->size;
+
+    while (size >= 4)
+    {
+        crc ^= static_cast<uint16_t>((data[0] << 8) | data[1]);
+        crc = static_cast<uint16_t>(SLICE4.slice[3][crc >> 8] ^ SLICE4.slice[2][crc & 0xff] ^ SLICE4.slice[1][data[2]] ^ SLICE4.slice[0][data[3]]);
+        data += 4;
+        size -= 4;
+    }
+
+    while (size--)
+    {
+        crc = static_cast<uint16_t>((crc << 8) ^ SLICE4.slice[0][((crc >> 8) ^ *data++) & 0xff]);
+    }
+
+    return crc;
+}
+
+uint16_t checksum_crc_reflected_slice4(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    const uint8_t *data = _chunk->space;
+    size_t size = _chunk->size;
+
+    while (size >= 4)
+    {
+        crc ^= static_cast<uint16_t>(data[0] | (data[1] << 8));
+        crc = static_cast<uint16_t>(SLICE4_REFLECTED.slice[3][crc & 0xff] ^ SLICE4_REFLECTED.slice[2][crc >> 8] ^ SLICE4_REFLECTED.slice[1][data[2]]
+                                    ^ SLICE4_REFLECTED.slice[0][data[3]]);
+        data += 4;
+        size -= 4;
+    }
+
+    while (size--)
+    {
+        crc = static_cast<uint16_t>((crc >> 8) ^ SLICE4_REFLECTED.slice[0][(crc ^ *data++) & 0xff]);
+    }
+
+    return crc;
+}
+
+uint16_t checksum_engine_crc_byte(const uint8_t _value, const uint16_t _crc)
+{
+#if CHECKSUM_CRC_ENGINE == CHECKSUM_CRC_ENGINE_BITWISE
+    return checksum_crc_byte(_value, _crc);
+#else
+    return update(_value, _crc);
+#endif
+}
+
+uint16_t checksum_engine_crc(const chunk_t *const _chunk, const uint16_t _crc)
+{
+#if CHECKSUM_CRC_ENGINE == CHECKSUM_CRC_ENGINE_SLICE4
+    return checksum_crc_slice4(_chunk, _crc);
+#elif CHECKSUM_CRC_ENGINE == CHECKSUM_CRC_ENGINE_TABLE
+    return checksum_crc_table(_chunk, _crc);
+#else
+    return checksum_crc(_chunk, _crc);
+#endif
+}
+
+uint16_t checksum_engine_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+{
+#if CHECKSUM_CRC_ENGINE == CHECKSUM_CRC_ENGINE_SLICE4
+    return checksum_crc_reflected_slice4(_chunk, _crc);
+#elif CHECKSUM_CRC_ENGINE == CHECKSUM_CRC_ENGINE_TABLE
+    return checksum_crc_reflected_table(_chunk, _crc);
+#else
+    return checksum_crc_reflected(_chunk, _crc);
+#endif
+}
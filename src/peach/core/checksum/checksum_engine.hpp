@@ -0,0 +1,115 @@
+/**
+ * \file checksum_engine.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* available crc engines, select one via CHECKSUM_CRC_ENGINE */
+#define CHECKSUM_CRC_ENGINE_BITWISE 0
+#define CHECKSUM_CRC_ENGINE_TABLE 1
+#define CHECKSUM_CRC_ENGINE_SLICE4 2
+
+#ifndef CHECKSUM_CRC_ENGINE
+#define CHECKSUM_CRC_ENGINE CHECKSUM_CRC_ENGINE_TABLE
+#endif
+
+namespace core::checksum::engine
+{
+    static const uint16_t POLYNOMIAL = 0x1021;
+    static const uint16_t POLYNOMIAL_REFLECTED = 0x8408;
+
+    static const size_t TABLE_SIZE = 256;
+
+    /**
+     * \brief Lookup tables of the crc engine.
+     *
+     * Slice 0 is the classic byte table, slice k holds the crc of a byte
+     * followed by k zero bytes, which lets the slicing variant fold four
+     * bytes per step.
+     */
+    template <size_t SLICES>
+    struct table_t
+    {
+        uint16_t slice[SLICES][TABLE_SIZE];
+    };
+
+    template <size_t SLICES>
+    constexpr table_t<SLICES> generate_table()
+    {
+        table_t<SLICES> table{};
+
+        for (size_t i = 0; i < TABLE_SIZE; ++i)
+        {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ POLYNOMIAL) : static_cast<uint16_t>(crc << 1);
+            }
+            table.slice[0][i] = crc;
+        }
+
+        for (size_t k = 1; k < SLICES; ++k)
+        {
+            for (size_t i = 0; i < TABLE_SIZE; ++i)
+            {
+                const uint16_t previous = table.slice[k - 1][i];
+                table.slice[k][i] = static_cast<uint16_t>((previous << 8) ^ table.slice[0][previous >> 8]);
+            }
+        }
+
+        return table;
+    }
+
+    template <size_t SLICES>
+    constexpr table_t<SLICES> generate_table_reflected()
+    {
+        table_t<SLICES> table{};
+
+        for (size_t i = 0; i < TABLE_SIZE; ++i)
+        {
+            uint16_t crc = static_cast<uint16_t>(i);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 0x0001) ? static_cast<uint16_t>((crc >> 1) ^ POLYNOMIAL_REFLECTED) : static_cast<uint16_t>(crc >> 1);
+            }
+            table.slice[0][i] = crc;
+        }
+
+        for (size_t k = 1; k < SLICES; ++k)
+        {
+            for (size_t i = 0; i < TABLE_SIZE; ++i)
+            {
+                const uint16_t previous = table.slice[k - 1][i];
+                table.slice[k][i] = static_cast<uint16_t>((previous >> 8) ^ table.slice[0][previous & 0xff]);
+            }
+        }
+
+        return table;
+    }
+
+    static_assert(generate_table<1>().slice[0][1] == POLYNOMIAL, "wrong crc table");
+    static_assert(generate_table_reflected<1>().slice[0][0x80] == POLYNOMIAL_REFLECTED, "wrong reflected crc table");
+}
+
+/* table driven, 256 entries per direction */
+uint16_t checksum_crc_byte_table(const uint8_t _value, const uint16_t _crc);
+uint16_t checksum_crc_table(const chunk_t *const _chunk, const uint16_t _crc);
+uint16_t checksum_crc_reflected_table(const chunk_t *const _chunk, const uint16_t _crc);
+
+/* slicing by four, 4x256 entries per direction */
+uint16_t checksum_crc_slice4(const chunk_t *const _chunk, const uint16_t _crc);
+uint16_t checksum_crc_reflected_slice4(const chunk_t *const _chunk, const uint16_t _crc);
+
+/* engine selected by CHECKSUM_CRC_ENGINE, results are identical to checksum_crc* */
+uint16_t checksum_engine_crc_byte(const uint8_t _value, const uint16_t _crc);
+uint16_t checksum_engine_crc(const chunk_t *const _chunk, const uint16_t _crc);
+uint16_t checksum_engine_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc);
@@ -0,0 +1,57 @@
+/**
+ * \file checksum_stream.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "checksum_stream.hpp"
+
+#include "checksum.hpp"
+#include "checksum_engine.hpp"
+
+void checksum_init(checksum_context_t *const _context, const checksum_stream_t _type, const uint16_t _initial)
+{
+    _context->type = _type;
+    _context->value = _initial;
+    _context->length = 0;
+}
+
+void checksum_update(checksum_context_t *const _context, const chunk_t *const _chunk)
+{
+    switch (_context->type)
+    {
+        case CHECKSUM_STREAM_SUM:
+            _context->value = checksum_sum(_chunk, _context->value);
+            break;
+        case CHECKSUM_STREAM_CRC:
+            _context->value = checksum_engine_crc(_chunk, _context->value);
+            break;
+        case CHECKSUM_STREAM_CRC_REFLECTED:
+            _context->value = checksum_engine_crc_reflected(_chunk, _context->value);
+            break;
+    }
+
+    _context->length += _chunk->size;
+}
+
+void checksum_update_byte(checksum_context_t *const _context, const uint8_t _value)
+{
+    uint8_t value = _value;
+    const chunk_t chunk = {&value, 1};
+    checksum_update(_context, &chunk);
+}
+
+void checksum_update_sequence(checksum_context_t *const _context, const chunk_t *const _chunks, const size_t _count)
+{
+    for (size_t i = 0; i < _count; ++i)
+    {
+        checksum_update(_context, &_chunks[i]);
+    }
+}
+
+uint16_t checksum_finalize(const checksum_context_t *const _context)
+{
+    return _context->value;
+}
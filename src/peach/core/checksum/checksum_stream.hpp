@@ -0,0 +1,41 @@
+/**
+ * \file checksum_stream.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+    CHECKSUM_STREAM_SUM,
+    CHECKSUM_STREAM_CRC,
+    CHECKSUM_STREAM_CRC_REFLECTED,
+} checksum_stream_t;
+
+/**
+ * \brief Running checksum over a sequence of chunks.
+ *
+ * Feeding the chunks of a message one after another gives the same value
+ * as the one shot call over the concatenated data, without copying the
+ * pieces into one buffer first.
+ */
+typedef struct
+{
+    checksum_stream_t type;
+    uint16_t value;
+    size_t length;
+} checksum_context_t;
+
+void checksum_init(checksum_context_t *const _context, const checksum_stream_t _type, const uint16_t _initial);
+void checksum_update(checksum_context_t *const _context, const chunk_t *const _chunk);
+void checksum_update_byte(checksum_context_t *const _context, const uint8_t _value);
+void checksum_update_sequence(checksum_context_t *const _context, const chunk_t *const _chunks, const size_t _count);
+uint16_t checksum_finalize(const checksum_context_t *const _context);
@@ -0,0 +1,111 @@
+/**
+ * \file checksum_words.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace core::checksum::words
+{
+    /**
+     * \brief Byte wise reference walk, feeds every byte of the chunk to the step.
+     */
+    template <typename STEP>
+    uint32_t walk_bytes(const chunk_t *const _chunk, uint32_t _state, STEP _step)
+    {
+        const uint8_t *data = _chunk->space;
+        for (size_t i = 0; i < _chunk->size; ++i)
+        {
+            _state = _step(_state, data[i]);
+        }
+        return _state;
+    }
+
+    /**
+     * \brief Word wise walk with the same result as walk_bytes.
+     *
+     * Bytes up to the first word boundary and the trailing rest are read one
+     * by one, the aligned body is fetched with one 32 bit load per four bytes
+     * and unpacked in memory order (little endian). The memcpy on an aligned
+     * pointer compiles to a single word load and keeps strict aliasing intact.
+     * The step sees the same bytes in the same order, so a byte wise hash
+     * keeps its output when it walks with its own step.
+     */
+    template <typename STEP>
+    uint32_t walk_words(const chunk_t *const _chunk, uint32_t _state, STEP _step)
+    {
+        const uint8_t *data = _chunk->space;
+        size_t size = _chunk->size;
+
+        while (size && (reinterpret_cast<uintptr_t>(data) & 0x3))
+        {
+            _state = _step(_state, *data++);
+            size--;
+        }
+
+        while (size >= 4)
+        {
+            uint32_t value;
+            memcpy(&value, __builtin_assume_aligned(data, 4), sizeof(value));
+            data += 4;
+            _state = _step(_state, static_cast<uint8_t>(value));
+            _state = _step(_state, static_cast<uint8_t>(value >> 8));
+            _state = _step(_state, static_cast<uint8_t>(value >> 16));
+            _state = _step(_state, static_cast<uint8_t>(value >> 24));
+            size -= 4;
+        }
+
+        while (size--)
+        {
+            _state = _step(_state, *data++);
+        }
+
+        return _state;
+    }
+
+    /* byte steps of common 32 bit hashes */
+    struct one_at_a_time
+    {
+        static const uint32_t SEED = 0;
+
+        uint32_t operator()(uint32_t _hash, const uint8_t _value) const
+        {
+            _hash += _value;
+            _hash += _hash << 10;
+            _hash ^= _hash >> 6;
+            return _hash;
+        }
+
+        static uint32_t finalize(uint32_t _hash)
+        {
+            _hash += _hash << 3;
+            _hash ^= _hash >> 11;
+            _hash += _hash << 15;
+            return _hash;
+        }
+    };
+
+    struct fnv1a
+    {
+        static const uint32_t SEED = 0x811c9dc5;
+
+        uint32_t operator()(const uint32_t _hash, const uint8_t _value) const { return (_hash ^ _value) * 0x01000193; }
+
+        static uint32_t finalize(const uint32_t _hash) { return _hash; }
+    };
+
+    template <typename HASH>
+    uint32_t hash(const chunk_t *const _chunk)
+    {
+        return HASH::finalize(walk_words(_chunk, HASH::SEED, HASH()));
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * \file i2c_async.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "i2c_async.hpp"
+
+namespace core::driver::i2c
+{
+    AsyncMaster::AsyncMaster(BusInterface &_bus) :
+        bus(_bus)
+    {
+    }
+
+    void AsyncMaster::initialize()
+    {
+        bus.initialize();
+        head = 0;
+        tail = 0;
+        active = nullptr;
+        completed = 0;
+        failed = 0;
+    }
+
+    void AsyncMaster::shutdown()
+    {
+        bus.shutdown();
+        active = nullptr;
+        head = tail;
+    }
+
+    bool AsyncMaster::submit(transaction_t *const _transaction)
+    {
+        if (head - tail == QUEUE_SIZE)
+        {
+            return false;
+        }
+
+        _transaction->status = status_t::PENDING;
+        queue[head++ % QUEUE_SIZE] = _transaction;
+        return true;
+    }
+
+    void AsyncMaster::complete(transaction_t *const _transaction)
+    {
+        if (_transaction && _transaction->completion)
+        {
+            _transaction->completion(_transaction);
+        }
+    }
+
+    void AsyncMaster::next(transaction_t *_finished)
+    {
+        while (!active && head != tail)
+        {
+            transaction_t *const transaction = queue[tail++ % QUEUE_SIZE];
+            if (bus.start(transaction))
+            {
+                active = transaction;
+                started = tracer ? tracer->now() : 0;
+                break;
+            }
+
+            /* completions keep the submission order */
+            complete(_finished);
+            _finished = nullptr;
+
+            transaction->status = status_t::REJECTED;
+            completed++;
+            failed++;
+            if (tracer)
+            {
+                tracer->record(transaction, tracer->now());
+            }
+            complete(transaction);
+        }
+
+        complete(_finished);
+    }
+
+    void AsyncMaster::perform()
+    {
+        transaction_t *finished = nullptr;
+
+        if (active)
+        {
+            const status_t status = bus.poll();
+            if (status == status_t::PENDING)
+            {
+                return;
+            }
+
+            finished = active;
+            finished->status = status;
+            active = nullptr;
+
+            completed++;
+            failed += (status == status_t::DONE) ? 0 : 1;
+            if (tracer)
+            {
+                tracer->record(finished, started);
+            }
+        }
+
+        next(finished);
+    }
+}
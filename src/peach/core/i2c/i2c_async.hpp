@@ -0,0 +1,67 @@
+/**
+ * \file i2c_async.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "i2c_bus.hpp"
+#include "i2c_trace.hpp"
+#include "i2c_transaction.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::i2c
+{
+    /**
+     * \brief Non blocking master, transactions are queued and run in order.
+     *
+     * submit() only queues the descriptor, perform() from the main loop
+     * starts the next transaction as soon as the bus is free and calls the
+     * completion with the final status in the transaction. The next
+     * transaction is started before the completion runs, so the bus keeps
+     * going while the callback works.
+     *
+     * With a tracer every transaction is recorded with the time from bus
+     * start until perform() saw it finished, rejected ones with 0 us.
+     */
+    class AsyncMaster
+    {
+      public:
+        static const size_t QUEUE_SIZE = 16;
+
+        explicit AsyncMaster(BusInterface &_bus);
+
+        void initialize();
+        void perform();
+        void shutdown();
+
+        bool submit(transaction_t *const _transaction);
+
+        void set_tracer(Tracer *const _tracer) { tracer = _tracer; }
+
+        bool is_idle() const { return !active && head == tail; }
+        size_t get_pending() const { return head - tail + (active ? 1 : 0); }
+        uint32_t get_completed() const { return completed; }
+        uint32_t get_failed() const { return failed; }
+
+      protected:
+        void next(transaction_t *_finished);
+        void complete(transaction_t *const _transaction);
+
+        BusInterface &bus;
+        transaction_t *queue[QUEUE_SIZE];
+        size_t head = 0;
+        size_t tail = 0;
+
+        transaction_t *active = nullptr;
+        Tracer *tracer = nullptr;
+        uint64_t started = 0;
+        uint32_t completed = 0;
+        uint32_t failed = 0;
+    };
+}
@@ -0,0 +1,68 @@
+/**
+ * \file i2c_burst.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "i2c_burst.hpp"
+
+#include <string.h>
+
+namespace core::driver::i2c
+{
+    transaction_t *Burst::prepare(const uint8_t _address, const register_write_t *const _list, const size_t _count, completion_t _completion)
+    {
+        links = 0;
+        bytes = 0;
+
+        size_t next_location = 0;
+        for (size_t i = 0; i < _count; ++i)
+        {
+            const register_write_t &entry = _list[i];
+            if (entry.data.size == 0)
+            {
+                continue;
+            }
+
+            const bool merge = links && entry.location == next_location;
+            if (!merge)
+            {
+                if (links == MAX_LINKS || bytes + 1 + entry.data.size > MAX_BYTES)
+                {
+                    links = 0;
+                    return nullptr;
+                }
+
+                /* a new link starts with the register address */
+                chain[links] = transaction_t{_address, chunk_t{&buffer[bytes], 1}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE};
+                if (links)
+                {
+                    chain[links - 1].chain = &chain[links];
+                }
+                buffer[bytes++] = entry.location;
+                links++;
+            }
+            else if (bytes + entry.data.size > MAX_BYTES)
+            {
+                links = 0;
+                return nullptr;
+            }
+
+            memcpy(&buffer[bytes], entry.data.space, entry.data.size);
+            bytes += entry.data.size;
+            chain[links - 1].write.size += entry.data.size;
+            next_location = entry.location + entry.data.size;
+        }
+
+        if (!links)
+        {
+            return nullptr;
+        }
+
+        chain[links - 1].chain = nullptr;
+        chain[0].completion = _completion;
+        return &chain[0];
+    }
+}
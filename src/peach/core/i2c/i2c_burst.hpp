@@ -0,0 +1,58 @@
+/**
+ * \file i2c_burst.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+#include "i2c_transaction.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::i2c
+{
+    struct register_write_t
+    {
+        uint8_t location;
+        chunk_t data;
+    };
+
+    /**
+     * \brief Writes a list of registers of one target in a single transaction.
+     *
+     * prepare() turns the (register, data) list into a transaction chain:
+     * an entry that starts where the previous one ended is appended to the
+     * same auto increment transfer, every other entry gets its own link
+     * after a repeated start. The list order is kept, so sort it by register
+     * address if the target does not care about the order.
+     *
+     * The data is copied, the list may go away after prepare(). The burst
+     * owns the chain until the completion of the returned transaction ran.
+     */
+    class Burst
+    {
+      public:
+        static const size_t MAX_LINKS = 8;
+        static const size_t MAX_BYTES = 64;
+
+        /**
+         * \return head of the chain for AsyncMaster::submit() or BusInterface::start(),
+         *         nullptr if the list does not fit into the burst
+         */
+        transaction_t *prepare(const uint8_t _address, const register_write_t *const _list, const size_t _count, completion_t _completion);
+
+        size_t get_links() const { return links; }
+        size_t get_bytes() const { return bytes; }
+
+      protected:
+        transaction_t chain[MAX_LINKS];
+        uint8_t buffer[MAX_BYTES];
+        size_t links = 0;
+        size_t bytes = 0;
+    };
+}
@@ -0,0 +1,510 @@
+/**
+ * \file i2c_bus.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "i2c_bus.hpp"
+
+#if PICO_ON_DEVICE
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <pico/stdlib.h>
+#endif
+
+namespace core::driver::i2c
+{
+    namespace
+    {
+        /*
+            per link: (repeated) start, address + ack, 9 bits per byte,
+            repeated start and address for the read; one stop at the end
+        */
+        uint64_t transaction_bits(const transaction_t *const _transaction)
+        {
+            uint64_t bits = 1;
+            for (const transaction_t *link = _transaction; link; link = link->chain)
+            {
+                bits += 1 + 9 + 9 * static_cast<uint64_t>(link->write.size);
+                if (link->read.size)
+                {
+                    bits += (link->write.size ? 1 + 9 : 0) + 9 * static_cast<uint64_t>(link->read.size);
+                }
+            }
+            return bits;
+        }
+
+        /*
+            byte positions on the bus, address bytes included; returns the
+            position if a slave can NAK it (address or written byte)
+        */
+        size_t nack_position(const transaction_t *const _transaction, const size_t _requested, size_t *const _bytes)
+        {
+            size_t position = 0;
+            size_t result = LoopbackBus::NO_NACK;
+            for (const transaction_t *link = _transaction; link; link = link->chain)
+            {
+                const size_t ackable = 1 + link->write.size;
+                if (_requested >= position && _requested < position + ackable && result == LoopbackBus::NO_NACK)
+                {
+                    result = _requested;
+                }
+                position += ackable;
+
+                if (link->read.size)
+                {
+                    if (link->write.size)
+                    {
+                        result = (_requested == position && result == LoopbackBus::NO_NACK) ? _requested : result;
+                        position++;
+                    }
+                    position += link->read.size;
+                }
+            }
+            *_bytes = position;
+            return result;
+        }
+
+#if PICO_ON_DEVICE
+        const transaction_t *last_link(const transaction_t *_transaction)
+        {
+            while (_transaction->chain)
+            {
+                _transaction = _transaction->chain;
+            }
+            return _transaction;
+        }
+#endif
+    }
+
+    SimulatedBus::SimulatedBus(const config_t &_config) :
+        config(_config)
+    {
+    }
+
+    bool SimulatedBus::attach(const uint8_t _address, const chunk_t &_memory)
+    {
+        if (count == MAX_TARGETS || find(_address))
+        {
+            return false;
+        }
+
+        targets[count++] = target_t{_address, _memory, 0};
+        return true;
+    }
+
+    void SimulatedBus::initialize()
+    {
+        active = nullptr;
+        busy_us = 0;
+    }
+
+    void SimulatedBus::shutdown()
+    {
+        active = nullptr;
+    }
+
+    SimulatedBus::target_t *SimulatedBus::find(const uint8_t _address)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (targets[i].address == _address)
+            {
+                return &targets[i];
+            }
+        }
+        return nullptr;
+    }
+
+    bool SimulatedBus::start(transaction_t *const _transaction)
+    {
+        if (active || !config.frequency || !is_valid_chain(_transaction))
+        {
+            return false;
+        }
+
+        /* a missing target only costs the address byte */
+        const uint64_t bits = find(_transaction->address) ? transaction_bits(_transaction) : 1 + 9 + 1;
+        const uint64_t duration = (bits * 1000000 + config.frequency - 1) / config.frequency;
+
+        active = _transaction;
+        finish = config.clock() + duration;
+        busy_us += duration;
+        return true;
+    }
+
+    void SimulatedBus::transfer(target_t *const _target, const transaction_t *const _transaction)
+    {
+        const chunk_t &memory = _target->memory;
+
+        for (size_t i = 0; i < _transaction->write.size; ++i)
+        {
+            if (i == 0)
+            {
+                _target->pointer = _transaction->write.space[0];
+            }
+            else if (_target->pointer < memory.size)
+            {
+                memory.space[_target->pointer++] = _transaction->write.space[i];
+            }
+        }
+
+        for (size_t i = 0; i < _transaction->read.size; ++i)
+        {
+            _transaction->read.space[i] = (_target->pointer < memory.size) ? memory.space[_target->pointer++] : 0xff;
+        }
+    }
+
+    status_t SimulatedBus::poll()
+    {
+        if (!active)
+        {
+            return status_t::IDLE;
+        }
+
+        if (config.clock() < finish)
+        {
+            return status_t::PENDING;
+        }
+
+        target_t *const target = find(active->address);
+        for (const transaction_t *link = active; target && link; link = link->chain)
+        {
+            transfer(target, link);
+        }
+
+        active = nullptr;
+        return target ? status_t::DONE : status_t::NACK;
+    }
+
+    LoopbackBus::LoopbackBus(const config_t &_config) :
+        config(_config)
+    {
+    }
+
+    bool LoopbackBus::attach(const uint8_t _address, SlaveInterface &_slave, const uint32_t _stretch_us)
+    {
+        if (count == MAX_SLAVES || find(_address))
+        {
+            return false;
+        }
+
+        slaves[count++] = slave_t{_address, &_slave, _stretch_us, NO_NACK};
+        return true;
+    }
+
+    bool LoopbackBus::inject_nack(const uint8_t _address, const size_t _position)
+    {
+        slave_t *const slave = find(_address);
+        if (!slave)
+        {
+            return false;
+        }
+
+        slave->nack_at = _position;
+        return true;
+    }
+
+    void LoopbackBus::initialize()
+    {
+        active = nullptr;
+        busy_us = 0;
+        stretch_us = 0;
+        transactions = 0;
+        nacks = 0;
+    }
+
+    void LoopbackBus::shutdown()
+    {
+        active = nullptr;
+    }
+
+    LoopbackBus::slave_t *LoopbackBus::find(const uint8_t _address)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (slaves[i].address == _address)
+            {
+                return &slaves[i];
+            }
+        }
+        return nullptr;
+    }
+
+    bool LoopbackBus::start(transaction_t *const _transaction)
+    {
+        if (active || !config.frequency || !is_valid_chain(_transaction))
+        {
+            return false;
+        }
+
+        slave_t *const slave = find(_transaction->address);
+
+        /* nobody answers a missing slave, an injected NAK is used up by one transaction */
+        size_t bytes = 0;
+        nack_at = nack_position(_transaction, slave ? slave->nack_at : 0, &bytes);
+        if (slave)
+        {
+            slave->nack_at = NO_NACK;
+        }
+
+        /* the slave stretches after every byte it acknowledged */
+        const bool nacked = nack_at != NO_NACK;
+        const uint64_t bits = nacked ? 1 + 9 * (static_cast<uint64_t>(nack_at) + 1) + 1 : transaction_bits(_transaction);
+        const uint64_t stretch = slave ? static_cast<uint64_t>(slave->stretch_us) * (nacked ? nack_at : bytes) : 0;
+        const uint64_t duration = (bits * 1000000 + config.frequency - 1) / config.frequency + stretch;
+
+        active = _transaction;
+        finish = config.clock() + duration;
+        busy_us += duration;
+        stretch_us += stretch;
+        return true;
+    }
+
+    bool LoopbackBus::transfer(slave_t *const _slave, const transaction_t *const _transaction)
+    {
+        SlaveInterface &slave = *_slave->slave;
+        size_t position = 0;
+
+        for (const transaction_t *link = _transaction; link; link = link->chain)
+        {
+            if (link != _transaction)
+            {
+                /* repeated start */
+                slave.restart();
+            }
+
+            if (position++ == nack_at)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < link->write.size; ++i)
+            {
+                if (position++ == nack_at)
+                {
+                    return false;
+                }
+                slave.receive(link->write.space[i]);
+            }
+
+            if (link->read.size)
+            {
+                if (link->write.size)
+                {
+                    slave.restart();
+                    if (position++ == nack_at)
+                    {
+                        return false;
+                    }
+                }
+                for (size_t i = 0; i < link->read.size; ++i)
+                {
+                    link->read.space[i] = slave.request();
+                    position++;
+                }
+            }
+        }
+        return true;
+    }
+
+    status_t LoopbackBus::poll()
+    {
+        if (!active)
+        {
+            return status_t::IDLE;
+        }
+
+        if (config.clock() < finish)
+        {
+            return status_t::PENDING;
+        }
+
+        slave_t *const slave = find(active->address);
+        bool acknowledged = false;
+        if (slave)
+        {
+            acknowledged = transfer(slave, active);
+            if (nack_at != 0)
+            {
+                /* STOP, a slave that NAKed its address was never addressed */
+                slave->slave->stop();
+            }
+        }
+
+        active = nullptr;
+        transactions++;
+        nacks += acknowledged ? 0 : 1;
+        return acknowledged ? status_t::DONE : status_t::NACK;
+    }
+
+#if PICO_ON_DEVICE
+    DmaBus::DmaBus(const config_t &_config) :
+        config(_config)
+    {
+    }
+
+    void DmaBus::initialize()
+    {
+        i2c_init(config.i2c, config.frequency);
+        gpio_set_function(config.sda_pin, GPIO_FUNC_I2C);
+        gpio_set_function(config.scl_pin, GPIO_FUNC_I2C);
+        gpio_pull_up(config.sda_pin);
+        gpio_pull_up(config.scl_pin);
+
+        tx_channel = dma_claim_unused_channel(false);
+        rx_channel = dma_claim_unused_channel(false);
+        if (tx_channel < 0 || rx_channel < 0)
+        {
+            shutdown();
+            return;
+        }
+
+        config.i2c->hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+        active = nullptr;
+    }
+
+    void DmaBus::shutdown()
+    {
+        abort();
+
+        if (tx_channel >= 0)
+        {
+            dma_channel_unclaim(static_cast<uint>(tx_channel));
+            tx_channel = -1;
+        }
+        if (rx_channel >= 0)
+        {
+            dma_channel_unclaim(static_cast<uint>(rx_channel));
+            rx_channel = -1;
+        }
+
+        i2c_deinit(config.i2c);
+    }
+
+    void DmaBus::abort()
+    {
+        if (tx_channel >= 0)
+        {
+            dma_channel_abort(static_cast<uint>(tx_channel));
+        }
+        if (rx_channel >= 0)
+        {
+            dma_channel_abort(static_cast<uint>(rx_channel));
+        }
+        active = nullptr;
+    }
+
+    bool DmaBus::start(transaction_t *const _transaction)
+    {
+        size_t size = 0;
+        for (const transaction_t *link = _transaction; link; link = link->chain)
+        {
+            size += link->write.size + link->read.size;
+        }
+        if (active || tx_channel < 0 || !is_valid_chain(_transaction) || size > MAX_COMMANDS)
+        {
+            return false;
+        }
+
+        size_t index = 0;
+        for (const transaction_t *link = _transaction; link; link = link->chain)
+        {
+            const size_t first = index;
+            for (size_t i = 0; i < link->write.size; ++i)
+            {
+                commands[index++] = link->write.space[i];
+            }
+            for (size_t i = 0; i < link->read.size; ++i)
+            {
+                commands[index] = I2C_IC_DATA_CMD_CMD_BITS;
+                if (i == 0 && link->write.size)
+                {
+                    commands[index] |= I2C_IC_DATA_CMD_RESTART_BITS;
+                }
+                index++;
+            }
+
+            /* chained links follow after a repeated start instead of stop and start */
+            if (link != _transaction)
+            {
+                commands[first] |= I2C_IC_DATA_CMD_RESTART_BITS;
+            }
+        }
+        commands[index - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+        const transaction_t *const last = last_link(_transaction);
+
+        i2c_hw_t *const hw = config.i2c->hw;
+        hw->enable = 0;
+        hw->tar = _transaction->address;
+        hw->enable = 1;
+
+        /* reading the clear registers drops stale events of the last transaction */
+        (void)hw->clr_tx_abrt;
+        (void)hw->clr_stop_det;
+
+        if (last->read.size)
+        {
+            const uint rx_dma = static_cast<uint>(rx_channel);
+            dma_channel_config rx_config = dma_channel_get_default_config(rx_dma);
+            channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+            channel_config_set_read_increment(&rx_config, false);
+            channel_config_set_write_increment(&rx_config, true);
+            channel_config_set_dreq(&rx_config, i2c_get_dreq(config.i2c, false));
+            dma_channel_configure(rx_dma, &rx_config, last->read.space, &hw->data_cmd, static_cast<uint>(last->read.size), true);
+        }
+
+        const uint tx_dma = static_cast<uint>(tx_channel);
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_dma);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_32);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_dreq(&tx_config, i2c_get_dreq(config.i2c, true));
+        dma_channel_configure(tx_dma, &tx_config, &hw->data_cmd, commands, static_cast<uint>(size), true);
+
+        /* twice the nominal bus time, a stretching target gets some slack */
+        deadline = time_us_64() + 2 * transaction_bits(_transaction) * 1000000 / config.frequency + 1000;
+        active = _transaction;
+        return true;
+    }
+
+    status_t DmaBus::poll()
+    {
+        if (!active)
+        {
+            return status_t::IDLE;
+        }
+
+        i2c_hw_t *const hw = config.i2c->hw;
+
+        if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+        {
+            /* address or data NACK, the block already flushed its tx fifo */
+            abort();
+            (void)hw->clr_tx_abrt;
+            return status_t::NACK;
+        }
+
+        const bool transferred = !dma_channel_is_busy(static_cast<uint>(tx_channel)) &&
+                                 (last_link(active)->read.size == 0 || !dma_channel_is_busy(static_cast<uint>(rx_channel)));
+
+        if (transferred && (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS))
+        {
+            (void)hw->clr_stop_det;
+            active = nullptr;
+            return status_t::DONE;
+        }
+
+        if (time_us_64() > deadline)
+        {
+            hw_set_bits(&hw->enable, I2C_IC_ENABLE_ABORT_BITS);
+            abort();
+            return status_t::TIMEOUT;
+        }
+
+        return status_t::PENDING;
+    }
+#endif
+}
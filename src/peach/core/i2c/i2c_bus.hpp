@@ -0,0 +1,242 @@
+/**
+ * \file i2c_bus.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "i2c_transaction.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+#include <hardware/i2c.h>
+#endif
+
+namespace core::driver::i2c
+{
+    /**
+     * \brief Runs one transaction at a time without blocking.
+     *
+     * start() hands the transaction to the bus and returns at once, poll()
+     * returns PENDING until the bus finished and the final status after.
+     */
+    class BusInterface
+    {
+      public:
+        virtual ~BusInterface() = default;
+
+        virtual void initialize() = 0;
+        virtual void shutdown() = 0;
+
+        virtual bool start(transaction_t *const _transaction) = 0;
+        virtual status_t poll() = 0;
+    };
+
+    /**
+     * \brief Bus model with register targets.
+     *
+     * Every attached target is a register memory: the first written byte
+     * sets the register pointer, further bytes are written from there on,
+     * reads continue at the pointer. Unknown addresses NACK. A transaction
+     * takes the time of its bits (start, address, 9 bits per byte, repeated
+     * start, stop) at the bus frequency, the data moves when it completes.
+     * Chained links keep the register pointer rules of a new transaction.
+     */
+    class SimulatedBus : public BusInterface
+    {
+      public:
+        static const size_t MAX_TARGETS = 4;
+
+        struct config_t
+        {
+            uint32_t frequency;
+            clock_source_t clock;
+        };
+
+        explicit SimulatedBus(const config_t &_config);
+
+        bool attach(const uint8_t _address, const chunk_t &_memory);
+
+        void initialize() override;
+        void shutdown() override;
+
+        bool start(transaction_t *const _transaction) override;
+        status_t poll() override;
+
+        uint64_t get_busy_us() const { return busy_us; }
+
+      protected:
+        struct target_t
+        {
+            uint8_t address;
+            chunk_t memory;
+            size_t pointer;
+        };
+
+        target_t *find(const uint8_t _address);
+        void transfer(target_t *const _target, const transaction_t *const _transaction);
+
+        const config_t config;
+        target_t targets[MAX_TARGETS] = {};
+        size_t count = 0;
+
+        transaction_t *active = nullptr;
+        uint64_t finish = 0;
+        uint64_t busy_us = 0;
+    };
+
+    /**
+     * \brief Slave side of LoopbackBus, the events of the pico i2c slave isr.
+     *
+     * receive() gets every byte the master writes, request() delivers the
+     * next byte of a master read, restart() marks a repeated start and
+     * stop() the end of the transaction. The pico slave isr reports both
+     * as I2C_SLAVE_FINISH; a handler that cannot tell them apart calls
+     * stop(), which ends the transaction at every repeated start.
+     */
+    class SlaveInterface
+    {
+      public:
+        virtual ~SlaveInterface() = default;
+
+        virtual void receive(const uint8_t _value) = 0;
+        virtual uint8_t request() = 0;
+        virtual void restart() = 0;
+        virtual void stop() = 0;
+    };
+
+    /* connects a bank with receive/request/restart/stop (e.g. memory::ShadowBank) */
+    template <typename BANK>
+    class SlavePort : public SlaveInterface
+    {
+      public:
+        explicit SlavePort(BANK &_bank) :
+            bank(_bank)
+        {
+        }
+
+        void receive(const uint8_t _value) override { bank.receive(_value); }
+        uint8_t request() override { return bank.request(); }
+        void restart() override { bank.restart(); }
+        void stop() override { bank.stop(); }
+
+      protected:
+        BANK &bank;
+    };
+
+    /**
+     * \brief In-process bus between a master and slave implementations.
+     *
+     * The master side is the BusInterface of SimulatedBus, the slaves get
+     * the byte events of the real bus: a write byte by byte, restart() at
+     * a repeated start, a read byte by byte and stop() at STOP. The events run when
+     * the transaction completed on the simulated time line.
+     *
+     * - clock stretching: a slave holds SCL for stretch_us after each byte
+     * - NAK injection: inject_nack() lets the next transaction to a slave
+     *   NAK at a byte position (0 is the address byte); the bytes before
+     *   reach the slave, the master sees NACK
+     * - bus speed: frequency, busy and stretch time give the utilization
+     */
+    class LoopbackBus : public BusInterface
+    {
+      public:
+        static const size_t MAX_SLAVES = 4;
+        static const size_t NO_NACK = SIZE_MAX;
+
+        struct config_t
+        {
+            uint32_t frequency;
+            clock_source_t clock;
+        };
+
+        explicit LoopbackBus(const config_t &_config);
+
+        bool attach(const uint8_t _address, SlaveInterface &_slave, const uint32_t _stretch_us = 0);
+        bool inject_nack(const uint8_t _address, const size_t _position);
+
+        void initialize() override;
+        void shutdown() override;
+
+        bool start(transaction_t *const _transaction) override;
+        status_t poll() override;
+
+        uint64_t get_busy_us() const { return busy_us; }
+        uint64_t get_stretch_us() const { return stretch_us; }
+        uint32_t get_transactions() const { return transactions; }
+        uint32_t get_nacks() const { return nacks; }
+
+      protected:
+        struct slave_t
+        {
+            uint8_t address;
+            SlaveInterface *slave;
+            uint32_t stretch_us;
+            size_t nack_at;
+        };
+
+        slave_t *find(const uint8_t _address);
+        bool transfer(slave_t *const _slave, const transaction_t *const _transaction);
+
+        const config_t config;
+        slave_t slaves[MAX_SLAVES] = {};
+        size_t count = 0;
+
+        transaction_t *active = nullptr;
+        size_t nack_at = NO_NACK;
+        uint64_t finish = 0;
+        uint64_t busy_us = 0;
+        uint64_t stretch_us = 0;
+        uint32_t transactions = 0;
+        uint32_t nacks = 0;
+    };
+
+#if PICO_ON_DEVICE
+    /**
+     * \brief RP2040 i2c block in master mode, fed by DMA.
+     *
+     * The transaction is translated into data_cmd words (data, read, restart
+     * and stop flags) that one DMA channel pushes into the tx fifo, a second
+     * channel drains the rx fifo into the read buffer. poll() only looks at
+     * the DMA and abort state, the cpu is free while the bus runs. The block
+     * must not be used by core::driver::i2c::Master at the same time.
+     */
+    class DmaBus : public BusInterface
+    {
+      public:
+        static const size_t MAX_COMMANDS = 64;
+
+        struct config_t
+        {
+            i2c_inst_t *i2c;
+            uint sda_pin;
+            uint scl_pin;
+            uint frequency;
+        };
+
+        explicit DmaBus(const config_t &_config);
+
+        void initialize() override;
+        void shutdown() override;
+
+        bool start(transaction_t *const _transaction) override;
+        status_t poll() override;
+
+      protected:
+        void abort();
+
+        const config_t config;
+        int tx_channel = -1;
+        int rx_channel = -1;
+
+        uint32_t commands[MAX_COMMANDS];
+        transaction_t *active = nullptr;
+        uint64_t deadline = 0;
+    };
+#endif
+}
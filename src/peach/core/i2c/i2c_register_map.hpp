@@ -0,0 +1,142 @@
+/**
+ * \file i2c_register_map.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::i2c::memory
+{
+    static const size_t ADDRESS_SPACE = 0x100;
+    static const uint8_t NO_REGISTER = 0xff;
+
+    /* register at address, offset of the addressed byte inside it */
+    struct slot_t
+    {
+        uint8_t index;
+        uint8_t offset;
+    };
+
+    /* layout entry for registers without a memory type, e.g. describe<0x40, 8> */
+    template <size_t ADDRESS_VALUE, size_t SIZE_VALUE>
+    struct describe
+    {
+        static constexpr size_t ADDRESS = ADDRESS_VALUE;
+        static constexpr size_t SIZE = SIZE_VALUE;
+    };
+
+    namespace layout
+    {
+        struct area_t
+        {
+            size_t address;
+            size_t size;
+        };
+
+        template <typename... REGISTERS>
+        constexpr std::array<area_t, sizeof...(REGISTERS)> areas()
+        {
+            return {area_t{static_cast<size_t>(REGISTERS::ADDRESS), static_cast<size_t>(REGISTERS::SIZE)}...};
+        }
+
+        template <typename... REGISTERS>
+        constexpr bool in_range()
+        {
+            for (const area_t &area : areas<REGISTERS...>())
+            {
+                if (area.size == 0 || area.address + area.size > ADDRESS_SPACE)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename... REGISTERS>
+        constexpr bool disjoint()
+        {
+            constexpr std::array<area_t, sizeof...(REGISTERS)> list = areas<REGISTERS...>();
+            for (size_t i = 0; i < list.size(); ++i)
+            {
+                for (size_t j = i + 1; j < list.size(); ++j)
+                {
+                    if (list[i].address < list[j].address + list[j].size && list[j].address < list[i].address + list[i].size)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * \brief Register layout of a memory bank, resolved at compile time.
+     *
+     * REGISTERS are the register types of the bank (anything with ADDRESS
+     * and SIZE, e.g. memory::bla::register_t or describe<>). The map holds a
+     * table over the whole 8 bit register address space, so lookup() is one
+     * indexed load for every address, mapped or not (e.g. 0xFE). Registers
+     * outside of the address space or overlapping each other do not compile.
+     */
+    template <typename... REGISTERS>
+    class RegisterMap
+    {
+      public:
+        static constexpr size_t COUNT = sizeof...(REGISTERS);
+
+        static_assert(COUNT > 0 && COUNT < NO_REGISTER, "register count out of range");
+        static_assert(layout::in_range<REGISTERS...>(), "register outside of the address space");
+        static_assert(layout::disjoint<REGISTERS...>(), "registers overlap");
+
+        static constexpr std::array<layout::area_t, COUNT> AREAS = layout::areas<REGISTERS...>();
+
+        static constexpr slot_t lookup(const uint8_t _address) { return TABLE[_address]; }
+
+        static constexpr size_t address_of(const size_t _index) { return AREAS[_index].address; }
+        static constexpr size_t size_of(const size_t _index) { return AREAS[_index].size; }
+
+        /* storage offset for a bank that keeps the registers back to back */
+        static constexpr size_t offset_of(const size_t _index) { return OFFSETS[_index]; }
+        static constexpr size_t total_size() { return OFFSETS[COUNT]; }
+
+      private:
+        static constexpr std::array<slot_t, ADDRESS_SPACE> generate()
+        {
+            std::array<slot_t, ADDRESS_SPACE> table{};
+            for (slot_t &slot : table)
+            {
+                slot = slot_t{NO_REGISTER, 0};
+            }
+
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                for (size_t offset = 0; offset < AREAS[i].size; ++offset)
+                {
+                    table[AREAS[i].address + offset] = slot_t{static_cast<uint8_t>(i), static_cast<uint8_t>(offset)};
+                }
+            }
+            return table;
+        }
+
+        static constexpr std::array<size_t, COUNT + 1> offsets()
+        {
+            std::array<size_t, COUNT + 1> list{};
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                list[i + 1] = list[i] + AREAS[i].size;
+            }
+            return list;
+        }
+
+        static constexpr std::array<slot_t, ADDRESS_SPACE> TABLE = generate();
+        static constexpr std::array<size_t, COUNT + 1> OFFSETS = offsets();
+    };
+}
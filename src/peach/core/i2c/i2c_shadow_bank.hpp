@@ -0,0 +1,349 @@
+/**
+ * \file i2c_shadow_bank.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+#include "i2c_register_map.hpp"
+#include "i2c_trace.hpp"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace core::driver::i2c::memory
+{
+    /**
+     * \brief Register bank with consistent multi byte access in both directions.
+     *
+     * Every register has three copies per direction. A writer always works
+     * on a copy nobody else looks at and publishes it with one store, a
+     * reader latches the published copy when it starts:
+     *
+     * - application -> master: edit() returns a private copy of the
+     *   published value, publish() makes it visible. The slave latches the
+     *   published copy when a master read enters the register, so it sends
+     *   one consistent snapshot even if the application publishes meanwhile.
+     * - master -> application: master writes go into a private copy of the
+     *   last received value and are published at the end of the
+     *   transaction (stop()), fetch() copies the latest complete value. A
+     *   repeated start (restart()) only expects a new register pointer,
+     *   the writes of all parts of the transaction are published together.
+     *
+     * No read-modify-write atomics and no interrupt masking are needed, the
+     * slave side (receive/request/restart/stop, called from the i2c slave isr)
+     * must only run on the same core as the application.
+     *
+     * Register addressing follows the existing banks: the first byte the
+     * master writes sets the register pointer, reads and writes continue
+     * from there. Unmapped addresses read as 0xff and ignore writes.
+     *
+     * Change notification: the registers a master writes are marked dirty,
+     * several writes to one register within a transaction count once. At
+     * STOP registers written with their old value are dropped and the
+     * handler gets one call with the set of registers that really changed,
+     * e.g. to post it to the event bus. The handler runs in the isr.
+     *
+     * With a tracer every transaction from the first byte until STOP is
+     * recorded under the own slave address, bytes on unmapped addresses
+     * mark it as OVERFLOW.
+     */
+    template <typename MAP>
+    class ShadowBank
+    {
+      public:
+        static constexpr size_t COUNT = MAP::COUNT;
+
+        /* register bitmap, walk it with for (i = first(); i < COUNT; i = next(i)) */
+        struct changes_t
+        {
+            static const size_t WORDS = (COUNT + 31) / 32;
+
+            uint32_t mask[WORDS];
+
+            void insert(const size_t _index) { mask[_index / 32] |= 1u << (_index % 32); }
+            bool contains(const size_t _index) const { return mask[_index / 32] & (1u << (_index % 32)); }
+            void clear() { memset(mask, 0, sizeof(mask)); }
+
+            bool empty() const { return first() == COUNT; }
+            size_t first() const { return find(0); }
+            size_t next(const size_t _index) const { return find(_index + 1); }
+
+            size_t size() const
+            {
+                size_t result = 0;
+                for (const uint32_t word : mask)
+                {
+                    result += static_cast<size_t>(__builtin_popcount(word));
+                }
+                return result;
+            }
+
+          private:
+            size_t find(const size_t _from) const
+            {
+                for (size_t word = _from / 32; word < WORDS; ++word)
+                {
+                    const uint32_t bits = mask[word] & (word == _from / 32 ? ~0u << (_from % 32) : ~0u);
+                    if (bits)
+                    {
+                        return word * 32 + static_cast<size_t>(__builtin_ctz(bits));
+                    }
+                }
+                return COUNT;
+            }
+        };
+
+        typedef void (*change_handler_t)(const changes_t &_changes);
+
+        void initialize()
+        {
+            memset(outbound, 0, sizeof(outbound));
+            memset(inbound, 0, sizeof(inbound));
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                out_published[i].store(0);
+                out_reading[i].store(0);
+                in_published[i].store(0);
+                in_reading[i].store(0);
+                in_count[i].store(0);
+                seen[i] = 0;
+            }
+            written.clear();
+            stop();
+            notifications = 0;
+        }
+
+        void shutdown() {}
+
+        void set_handler(change_handler_t _handler) { handler = _handler; }
+
+        void set_tracer(Tracer *const _tracer, const uint8_t _address)
+        {
+            tracer = _tracer;
+            trace_address = _address;
+        }
+
+        /* application side */
+
+        uint8_t *edit(const size_t _index)
+        {
+            const uint8_t published = out_published[_index].load(std::memory_order_acquire);
+            const uint8_t reading = out_reading[_index].load(std::memory_order_acquire);
+
+            /* the slave can only move its latch onto the published copy, both are excluded */
+            out_back[_index] = free_copy(published, reading);
+
+            uint8_t *const back = copy(outbound, out_back[_index], _index);
+            memcpy(back, copy(outbound, published, _index), MAP::size_of(_index));
+            return back;
+        }
+
+        void publish(const size_t _index) { out_published[_index].store(out_back[_index], std::memory_order_release); }
+
+        void update(const size_t _index, const chunk_t &_data)
+        {
+            uint8_t *const back = edit(_index);
+            memcpy(back, _data.space, _data.size < MAP::size_of(_index) ? _data.size : MAP::size_of(_index));
+            publish(_index);
+        }
+
+        /**
+         * \brief Copies the last value the master wrote completely.
+         *
+         * \return true if the master changed the register since the last fetch
+         */
+        bool fetch(const size_t _index, uint8_t *const _target)
+        {
+            uint8_t published;
+            do
+            {
+                /* the slave may publish between load and latch, then latch again */
+                published = in_published[_index].load();
+                in_reading[_index].store(published);
+            } while (in_published[_index].load() != published);
+
+            memcpy(_target, copy(inbound, published, _index), MAP::size_of(_index));
+
+            const uint32_t count = in_count[_index].load(std::memory_order_acquire);
+            const bool fresh = count != seen[_index];
+            seen[_index] = count;
+            return fresh;
+        }
+
+        /* slave side, from the i2c slave isr */
+
+        void receive(const uint8_t _value)
+        {
+            trace_begin();
+            trace_received++;
+
+            if (expect_address)
+            {
+                expect_address = false;
+                pointer = _value;
+                return;
+            }
+
+            const slot_t slot = MAP::lookup(pointer++);
+            if (slot.index == NO_REGISTER)
+            {
+                trace_overflow = true;
+                return;
+            }
+
+            if (!written.contains(slot.index))
+            {
+                const uint8_t published = in_published[slot.index].load(std::memory_order_acquire);
+                in_back[slot.index] = free_copy(published, in_reading[slot.index].load(std::memory_order_acquire));
+                memcpy(copy(inbound, in_back[slot.index], slot.index), copy(inbound, published, slot.index), MAP::size_of(slot.index));
+                written.insert(slot.index);
+            }
+
+            copy(inbound, in_back[slot.index], slot.index)[slot.offset] = _value;
+        }
+
+        uint8_t request()
+        {
+            expect_address = false;
+            trace_begin();
+            trace_sent++;
+
+            const slot_t slot = MAP::lookup(pointer++);
+            if (slot.index == NO_REGISTER)
+            {
+                trace_overflow = true;
+                return 0xff;
+            }
+
+            if (slot.index != latched)
+            {
+                latched = slot.index;
+                out_reading[slot.index].store(out_published[slot.index].load(std::memory_order_acquire), std::memory_order_release);
+            }
+
+            return copy(outbound, out_reading[slot.index].load(std::memory_order_relaxed), slot.index)[slot.offset];
+        }
+
+        /* repeated start, the transaction goes on */
+        void restart()
+        {
+            latched = NO_REGISTER;
+            expect_address = true;
+        }
+
+        void stop()
+        {
+            changes_t changes = {};
+            for (size_t i = written.first(); i < COUNT; i = written.next(i))
+            {
+                const uint8_t published = in_published[i].load(std::memory_order_relaxed);
+                if (memcmp(copy(inbound, in_back[i], i), copy(inbound, published, i), MAP::size_of(i)) == 0)
+                {
+                    /* same value again, nothing to publish */
+                    continue;
+                }
+
+                in_published[i].store(in_back[i], std::memory_order_release);
+                in_count[i].store(in_count[i].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                changes.insert(i);
+            }
+
+            written.clear();
+            latched = NO_REGISTER;
+            expect_address = true;
+            trace_end();
+
+            if (!changes.empty())
+            {
+                notifications++;
+                if (handler)
+                {
+                    handler(changes);
+                }
+            }
+        }
+
+        uint32_t get_notifications() const { return notifications; }
+
+      private:
+        static const uint8_t COPIES = 3;
+
+        static uint8_t free_copy(const uint8_t _first, const uint8_t _second)
+        {
+            for (uint8_t i = 0; i < COPIES; ++i)
+            {
+                if (i != _first && i != _second)
+                {
+                    return i;
+                }
+            }
+            return 0;
+        }
+
+        void trace_begin()
+        {
+            if (tracer && !tracing)
+            {
+                tracing = true;
+                trace_start = tracer->now();
+                trace_received = 0;
+                trace_sent = 0;
+                trace_overflow = false;
+            }
+        }
+
+        void trace_end()
+        {
+            if (!tracing)
+            {
+                return;
+            }
+            tracing = false;
+
+            const direction_t direction = trace_sent ? (trace_received ? direction_t::WRITE_READ : direction_t::READ) : direction_t::WRITE;
+            tracer->record(trace_address, direction, trace_received + trace_sent, trace_overflow ? status_t::OVERFLOW : status_t::DONE, trace_start);
+        }
+
+        static uint8_t *copy(uint8_t (&_space)[COPIES][MAP::total_size()], const uint8_t _copy, const size_t _index)
+        {
+            return &_space[_copy][MAP::offset_of(_index)];
+        }
+
+        uint8_t outbound[COPIES][MAP::total_size()];
+        uint8_t inbound[COPIES][MAP::total_size()];
+
+        std::atomic<uint8_t> out_published[COUNT];
+        std::atomic<uint8_t> out_reading[COUNT];
+        std::atomic<uint8_t> in_published[COUNT];
+        std::atomic<uint8_t> in_reading[COUNT];
+        std::atomic<uint32_t> in_count[COUNT];
+
+        /* application owned */
+        uint8_t out_back[COUNT] = {};
+        uint32_t seen[COUNT] = {};
+
+        /* slave owned */
+        uint8_t in_back[COUNT] = {};
+        changes_t written = {};
+        change_handler_t handler = nullptr;
+        uint32_t notifications = 0;
+
+        Tracer *tracer = nullptr;
+        uint64_t trace_start = 0;
+        size_t trace_received = 0;
+        size_t trace_sent = 0;
+        uint8_t trace_address = 0;
+        bool trace_overflow = false;
+        bool tracing = false;
+        uint8_t pointer = 0;
+        uint8_t latched = NO_REGISTER;
+        bool expect_address = true;
+    };
+}
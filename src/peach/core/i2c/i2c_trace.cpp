@@ -0,0 +1,152 @@
+/**
+ * \file i2c_trace.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "i2c_trace.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace core::driver::i2c
+{
+    namespace
+    {
+        const char *name_of(const status_t _status)
+        {
+            switch (_status)
+            {
+                case status_t::IDLE:
+                    return "idle";
+                case status_t::PENDING:
+                    return "pending";
+                case status_t::DONE:
+                    return "done";
+                case status_t::NACK:
+                    return "nack";
+                case status_t::TIMEOUT:
+                    return "timeout";
+                case status_t::REJECTED:
+                    return "rejected";
+                case status_t::OVERFLOW:
+                    return "overflow";
+            }
+            return "?";
+        }
+
+        const char *name_of(const direction_t _direction)
+        {
+            switch (_direction)
+            {
+                case direction_t::WRITE:
+                    return "w";
+                case direction_t::READ:
+                    return "r";
+                case direction_t::WRITE_READ:
+                    return "wr";
+            }
+            return "?";
+        }
+
+        void print_histogram(const char *const _title, const uint32_t *const _bins, const size_t _count)
+        {
+            printf("%s:", _title);
+            for (size_t i = 0; i < _count; ++i)
+            {
+                if (_bins[i])
+                {
+                    printf(" <%lu:%lu", i + 1 < _count ? static_cast<uint32_t>(1u << i) : 0xffffffffu, _bins[i]);
+                }
+            }
+            printf("\n");
+        }
+
+        void print_trace(const trace_t &_trace)
+        {
+            printf("%10lu us 0x%02x %-2s %4u bytes %6lu us %s\n",
+                   _trace.timestamp_us,
+                   _trace.address,
+                   name_of(_trace.direction),
+                   _trace.length,
+                   _trace.duration_us,
+                   name_of(_trace.status));
+        }
+    }
+
+    Tracer::Tracer(clock_source_t _clock) :
+        clock(_clock)
+    {
+        reset();
+    }
+
+    void Tracer::reset()
+    {
+        memset(ring, 0, sizeof(ring));
+        memset(&slowest, 0, sizeof(slowest));
+        memset(latency, 0, sizeof(latency));
+        memset(size, 0, sizeof(size));
+        total = 0;
+        failed = 0;
+    }
+
+    size_t Tracer::bin_of(const uint32_t _value)
+    {
+        const size_t bin = _value ? static_cast<size_t>(32 - __builtin_clz(_value)) : 0;
+        return bin < BINS ? bin : BINS - 1;
+    }
+
+    void Tracer::record(const uint8_t _address, const direction_t _direction, const size_t _length, const status_t _status, const uint64_t _start)
+    {
+        const uint32_t duration = static_cast<uint32_t>(clock() - _start);
+        const uint16_t length = static_cast<uint16_t>(_length < 0xffff ? _length : 0xffff);
+
+        trace_t &trace = ring[total % RECORDS];
+        trace = trace_t{static_cast<uint32_t>(_start), duration, length, _address, _direction, _status};
+
+        if (duration >= slowest.duration_us)
+        {
+            slowest = trace;
+        }
+
+        total++;
+        failed += (_status == status_t::DONE) ? 0 : 1;
+        latency[bin_of(duration)]++;
+        size[bin_of(length)]++;
+    }
+
+    void Tracer::record(const transaction_t *const _transaction, const uint64_t _start)
+    {
+        size_t written = 0;
+        size_t read = 0;
+        for (const transaction_t *link = _transaction; link; link = link->chain)
+        {
+            written += link->write.size;
+            read += link->read.size;
+        }
+
+        const direction_t direction = read ? (written ? direction_t::WRITE_READ : direction_t::READ) : direction_t::WRITE;
+        record(_transaction->address, direction, written + read, _transaction->status, _start);
+    }
+
+    void Tracer::dump() const
+    {
+        printf("i2c trace: %lu transactions, %lu failed\n", total, failed);
+        print_histogram("duration us", latency, BINS);
+        print_histogram("length bytes", size, BINS);
+
+        if (total)
+        {
+            printf("slowest:\n");
+            print_trace(slowest);
+        }
+
+        printf("last %u:\n", static_cast<unsigned>(get_count()));
+        for (size_t i = get_count(); i > 0; --i)
+        {
+            print_trace(get(i - 1));
+        }
+    }
+}
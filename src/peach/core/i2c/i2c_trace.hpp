@@ -0,0 +1,83 @@
+/**
+ * \file i2c_trace.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "i2c_transaction.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::i2c
+{
+    enum class direction_t : uint8_t
+    {
+        WRITE,
+        READ,
+        WRITE_READ,
+    };
+
+    struct trace_t
+    {
+        uint32_t timestamp_us;
+        uint32_t duration_us;
+        uint16_t length;
+        uint8_t address;
+        direction_t direction;
+        status_t status;
+    };
+
+    /**
+     * \brief Keeps the last transactions and timing statistics in RAM.
+     *
+     * record() costs a few stores: the transaction goes into a fixed ring
+     * (the oldest entry is overwritten) and into two histograms with power
+     * of two bins, bin n counts values from 2^(n-1) to 2^n - 1, the last bin
+     * everything above. The slowest transaction is kept apart, so it
+     * survives the ring. dump() prints everything on demand.
+     */
+    class Tracer
+    {
+      public:
+        static const size_t RECORDS = 64;
+        static const size_t BINS = 16;
+
+        explicit Tracer(clock_source_t _clock);
+
+        void reset();
+
+        uint64_t now() const { return clock(); }
+
+        void record(const uint8_t _address, const direction_t _direction, const size_t _length, const status_t _status, const uint64_t _start);
+        void record(const transaction_t *const _transaction, const uint64_t _start);
+
+        /* 0 is the newest record, up to get_count() - 1 */
+        const trace_t &get(const size_t _age) const { return ring[(total - 1 - _age) % RECORDS]; }
+        size_t get_count() const { return total < RECORDS ? total : RECORDS; }
+        uint32_t get_total() const { return total; }
+        uint32_t get_failed() const { return failed; }
+        const trace_t &get_slowest() const { return slowest; }
+
+        uint32_t get_latency(const size_t _bin) const { return latency[_bin]; }
+        uint32_t get_size(const size_t _bin) const { return size[_bin]; }
+
+        static size_t bin_of(const uint32_t _value);
+
+        void dump() const;
+
+      protected:
+        const clock_source_t clock;
+
+        trace_t ring[RECORDS];
+        trace_t slowest;
+        uint32_t total = 0;
+        uint32_t failed = 0;
+        uint32_t latency[BINS];
+        uint32_t size[BINS];
+    };
+}
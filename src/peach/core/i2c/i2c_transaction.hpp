@@ -0,0 +1,72 @@
+/**
+ * \file i2c_transaction.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::i2c
+{
+    typedef uint64_t (*clock_source_t)(void);
+
+    enum class status_t
+    {
+        IDLE,
+        PENDING,
+        DONE,
+        NACK,
+        TIMEOUT,
+        REJECTED,
+        OVERFLOW,
+    };
+
+    struct transaction_t;
+    typedef void (*completion_t)(transaction_t *const _transaction);
+
+    /*
+        write only:     write.size > 0, read.size == 0
+        read only:      write.size == 0, read.size > 0
+        write and read: both, the read follows after a repeated start
+
+        register access puts the register address in front of the write
+        data, the buffers belong to the caller until the completion ran
+
+        chain links further transactions to the same address, each one
+        follows after a repeated start and one STOP ends the whole chain;
+        only the last link may read, completion and status belong to the
+        first transaction (see Burst)
+    */
+    struct transaction_t
+    {
+        uint8_t address;
+        chunk_t write;
+        chunk_t read;
+        completion_t completion;
+        status_t status;
+        const transaction_t *chain = nullptr;
+    };
+
+    inline bool is_valid_chain(const transaction_t *const _transaction)
+    {
+        for (const transaction_t *link = _transaction; link; link = link->chain)
+        {
+            if (link->write.size == 0 && link->read.size == 0)
+            {
+                return false;
+            }
+            if (link->chain && (link->read.size || link->chain->address != _transaction->address))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,200 @@
+/**
+ * \file packet.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "packet.hpp"
+
+#include "checksum_engine.hpp"
+#include "checksum_stream.hpp"
+
+namespace core::packet
+{
+    namespace
+    {
+        inline uint8_t &at(const spscring_span_t *const _span, const size_t _index)
+        {
+            return (_index < _span->piece[0].size) ? _span->piece[0].space[_index] : _span->piece[1].space[_index - _span->piece[0].size];
+        }
+
+        void truncate(spscring_span_t *const _span, const size_t _size)
+        {
+            if (_size <= _span->piece[0].size)
+            {
+                _span->piece[0].size = _size;
+                _span->piece[1].size = 0;
+            }
+            else
+            {
+                _span->piece[1].size = _size - _span->piece[0].size;
+            }
+        }
+
+        /* COBS encoder writing into a ring region */
+        class Encoder
+        {
+          public:
+            explicit Encoder(const spscring_span_t *const _span) :
+                span(_span)
+            {
+            }
+
+            void put(const uint8_t _value)
+            {
+                if (_value == DELIMITER)
+                {
+                    close();
+                    return;
+                }
+
+                at(span, position++) = _value;
+                if (++code == 0xff)
+                {
+                    close();
+                }
+            }
+
+            size_t finish()
+            {
+                close();
+                at(span, code_position) = DELIMITER;
+                return code_position + 1;
+            }
+
+          private:
+            void close()
+            {
+                at(span, code_position) = code;
+                code_position = position++;
+                code = 1;
+            }
+
+            const spscring_span_t *const span;
+            size_t code_position = 0;
+            size_t position = 1;
+            uint8_t code = 1;
+        };
+    }
+
+    bool transmit(spscring_t *const _tx, const chunk_t *const _payload)
+    {
+        spscring_span_t span;
+
+        if (spscring_write_acquire(_tx, &span) < frame_size(_payload->size))
+        {
+            return false;
+        }
+
+        const uint16_t crc = checksum_engine_crc(_payload, 0);
+
+        Encoder encoder(&span);
+        for (size_t i = 0; i < _payload->size; ++i)
+        {
+            encoder.put(_payload->space[i]);
+        }
+        encoder.put(static_cast<uint8_t>(crc >> 8));
+        encoder.put(static_cast<uint8_t>(crc));
+
+        spscring_write_commit(_tx, encoder.finish());
+
+        return true;
+    }
+
+    bool Receiver::decode(spscring_span_t *const _frame, const size_t _size, size_t *const _payload)
+    {
+        /* in place, the write position never overtakes the read position */
+        size_t read = 0;
+        size_t write = 0;
+
+        while (read < _size)
+        {
+            const uint8_t code = at(_frame, read++);
+            if (code == DELIMITER || read + code - 1 > _size)
+            {
+                return false;
+            }
+
+            for (uint8_t i = 1; i < code; ++i)
+            {
+                at(_frame, write++) = at(_frame, read++);
+            }
+
+            if (code != 0xff && read < _size)
+            {
+                at(_frame, write++) = DELIMITER;
+            }
+        }
+
+        if (write < CRC_SIZE)
+        {
+            return false;
+        }
+
+        *_payload = write - CRC_SIZE;
+        const uint16_t expected = static_cast<uint16_t>((at(_frame, *_payload) << 8) | at(_frame, *_payload + 1));
+
+        spscring_span_t payload = *_frame;
+        truncate(&payload, *_payload);
+
+        checksum_context_t crc;
+        checksum_init(&crc, CHECKSUM_STREAM_CRC, 0);
+        checksum_update_sequence(&crc, payload.piece, 2);
+
+        return checksum_finalize(&crc) == expected;
+    }
+
+    bool Receiver::receive(spscring_t *const _rx, spscring_span_t *const _payload)
+    {
+        spscring_span_t span;
+
+        while (frame == 0)
+        {
+            const size_t count = spscring_read_acquire(_rx, &span);
+
+            /* continue the delimiter search where the last call stopped */
+            while (scanned < count && at(&span, scanned) != DELIMITER)
+            {
+                scanned++;
+            }
+
+            if (scanned == count)
+            {
+                if (count == spscring_capacity(_rx))
+                {
+                    /* no delimiter in a full ring, the frame can never complete */
+                    errors++;
+                    spscring_read_commit(_rx, count);
+                    scanned = 0;
+                }
+                return false;
+            }
+
+            size_t size = 0;
+            if (scanned && decode(&span, scanned, &size))
+            {
+                truncate(&span, size);
+                *_payload = span;
+                frame = scanned + 1;
+                packets++;
+                return true;
+            }
+
+            /* damaged or empty frame, resync behind its delimiter */
+            errors += scanned ? 1 : 0;
+            spscring_read_commit(_rx, scanned + 1);
+            scanned = 0;
+        }
+
+        return false;
+    }
+
+    void Receiver::release(spscring_t *const _rx)
+    {
+        spscring_read_commit(_rx, frame);
+        frame = 0;
+        scanned = 0;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * \file packet.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+#include "spscring.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::packet
+{
+    /*
+        frame layout: COBS(payload, crc16 high, crc16 low) 0x00
+
+        the crc is checksum_crc over the payload with initial value 0, COBS
+        removes every zero from the frame so the delimiter always marks its
+        end and a damaged frame never costs more than itself
+    */
+    static const uint8_t DELIMITER = 0x00;
+    static const size_t CRC_SIZE = 2;
+
+    /* worst case frame size for a payload, delimiter included */
+    constexpr size_t frame_size(const size_t _payload)
+    {
+        return _payload + CRC_SIZE + (_payload + CRC_SIZE) / 254 + 1 + 1;
+    }
+
+    /**
+     * \brief Encodes a payload straight into the tx ring.
+     *
+     * \return false without touching the ring if the frame does not fit
+     */
+    bool transmit(spscring_t *const _tx, const chunk_t *const _payload);
+
+    /**
+     * \brief Frame parser working in place in the rx ring.
+     *
+     * receive() decodes the next complete frame inside the ring memory and
+     * hands out the payload as a view, release() consumes the frame once the
+     * payload was processed. Frames with bad coding or crc are dropped and
+     * counted, parsing continues behind their delimiter.
+     */
+    class Receiver
+    {
+      public:
+        bool receive(spscring_t *const _rx, spscring_span_t *const _payload);
+        void release(spscring_t *const _rx);
+
+        uint32_t get_packets() const { return packets; }
+        uint32_t get_errors() const { return errors; }
+
+      private:
+        bool decode(spscring_span_t *const _frame, const size_t _size, size_t *const _payload);
+
+        size_t scanned = 0;
+        size_t frame = 0;
+        uint32_t packets = 0;
+        uint32_t errors = 0;
+    };
+}
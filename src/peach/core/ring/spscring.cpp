@@ -0,0 +1,308 @@
+/**
+ * \file spscring.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "spscring.hpp"
+
+#include <string.h>
+
+namespace
+{
+    void split(const spscring_t *const _ring, const size_t _position, const size_t _size, spscring_span_t *const _span)
+    {
+        const size_t offset = _position & _ring->mask;
+        const size_t first = (_size < _ring->chunk.size - offset) ? _size : _ring->chunk.size - offset;
+
+        _span->piece[0].space = &_ring->chunk.space[offset];
+        _span->piece[0].size = first;
+        _span->piece[1].space = _ring->chunk.space;
+        _span->piece[1].size = _size - first;
+    }
+
+#if SPSCRING_STATISTICS
+    /* single writer per counter, a relaxed load and store is enough and stays lock free on M0+ */
+    inline void add(std::atomic<uint32_t> &_counter, const size_t _value)
+    {
+        _counter.store(_counter.load(std::memory_order_relaxed) + static_cast<uint32_t>(_value), std::memory_order_relaxed);
+    }
+
+    inline void produced(spscring_t *const _ring, const size_t _fill, const size_t _accepted, const size_t _rejected)
+    {
+        add(_ring->statistics.written, _accepted);
+        if (_rejected)
+        {
+            add(_ring->statistics.overflows, 1);
+            add(_ring->statistics.rejected, _rejected);
+        }
+        if (_fill > _ring->statistics.peak.load(std::memory_order_relaxed))
+        {
+            _ring->statistics.peak.store(static_cast<uint32_t>(_fill), std::memory_order_relaxed);
+        }
+    }
+
+    inline void consumed(spscring_t *const _ring, const size_t _accepted, const bool _underrun)
+    {
+        add(_ring->statistics.read, _accepted);
+        if (_underrun)
+        {
+            add(_ring->statistics.underruns, 1);
+        }
+    }
+#else
+    inline void produced(spscring_t *const, const size_t, const size_t, const size_t) {}
+    inline void consumed(spscring_t *const, const size_t, const bool) {}
+#endif
+}
+
+bool spscring_init(spscring_t *const _ring, const chunk_t _chunk)
+{
+    if (_chunk.space == nullptr || _chunk.size == 0 || (_chunk.size & (_chunk.size - 1)) != 0)
+    {
+        return false;
+    }
+
+    _ring->chunk = _chunk;
+    _ring->mask = _chunk.size - 1;
+    spscring_reset(_ring);
+    spscring_statistics_reset(_ring);
+
+    return true;
+}
+
+void spscring_reset(spscring_t *const _ring)
+{
+    /* only while neither side is active */
+    _ring->head.store(0, std::memory_order_relaxed);
+    _ring->tail.store(0, std::memory_order_release);
+}
+
+size_t spscring_capacity(const spscring_t *const _ring)
+{
+    return _ring->chunk.size;
+}
+
+size_t spscring_count(const spscring_t *const _ring)
+{
+    return _ring->head.load(std::memory_order_acquire) - _ring->tail.load(std::memory_order_relaxed);
+}
+
+size_t spscring_space(const spscring_t *const _ring)
+{
+    return _ring->chunk.size - (_ring->head.load(std::memory_order_relaxed) - _ring->tail.load(std::memory_order_acquire));
+}
+
+bool spscring_is_empty(const spscring_t *const _ring)
+{
+    return spscring_count(_ring) == 0;
+}
+
+bool spscring_is_full(const spscring_t *const _ring)
+{
+    return spscring_space(_ring) == 0;
+}
+
+bool spscring_push(spscring_t *const _ring, const uint8_t _value)
+{
+    const size_t head = _ring->head.load(std::memory_order_relaxed);
+
+    const size_t fill = head - _ring->tail.load(std::memory_order_acquire);
+
+    if (fill >= _ring->chunk.size)
+    {
+        produced(_ring, fill, 0, 1);
+        return false;
+    }
+
+    _ring->chunk.space[head & _ring->mask] = _value;
+    _ring->head.store(head + 1, std::memory_order_release);
+    produced(_ring, fill + 1, 1, 0);
+
+    return true;
+}
+
+size_t spscring_write(spscring_t *const _ring, const chunk_t *const _chunk)
+{
+    const size_t head = _ring->head.load(std::memory_order_relaxed);
+    const size_t space = _ring->chunk.size - (head - _ring->tail.load(std::memory_order_acquire));
+    const size_t size = (_chunk->size < space) ? _chunk->size : space;
+
+    spscring_span_t span;
+    split(_ring, head, size, &span);
+    memcpy(span.piece[0].space, _chunk->space, span.piece[0].size);
+    memcpy(span.piece[1].space, &_chunk->space[span.piece[0].size], span.piece[1].size);
+
+    _ring->head.store(head + size, std::memory_order_release);
+    produced(_ring, _ring->chunk.size - space + size, size, _chunk->size - size);
+
+    return size;
+}
+
+bool spscring_pop(spscring_t *const _ring, uint8_t *const _value)
+{
+    const size_t tail = _ring->tail.load(std::memory_order_relaxed);
+
+    if (_ring->head.load(std::memory_order_acquire) == tail)
+    {
+        consumed(_ring, 0, true);
+        return false;
+    }
+
+    *_value = _ring->chunk.space[tail & _ring->mask];
+    _ring->tail.store(tail + 1, std::memory_order_release);
+    consumed(_ring, 1, false);
+
+    return true;
+}
+
+bool spscring_peek(const spscring_t *const _ring, const size_t _index, uint8_t *const _value)
+{
+    const size_t tail = _ring->tail.load(std::memory_order_relaxed);
+
+    if (_ring->head.load(std::memory_order_acquire) - tail <= _index)
+    {
+        return false;
+    }
+
+    *_value = _ring->chunk.space[(tail + _index) & _ring->mask];
+
+    return true;
+}
+
+size_t spscring_read(spscring_t *const _ring, chunk_t *const _chunk)
+{
+    const size_t tail = _ring->tail.load(std::memory_order_relaxed);
+    const size_t count = _ring->head.load(std::memory_order_acquire) - tail;
+    const size_t size = (_chunk->size < count) ? _chunk->size : count;
+
+    spscring_span_t span;
+    split(_ring, tail, size, &span);
+    memcpy(_chunk->space, span.piece[0].space, span.piece[0].size);
+    memcpy(&_chunk->space[span.piece[0].size], span.piece[1].space, span.piece[1].size);
+
+    _ring->tail.store(tail + size, std::memory_order_release);
+    consumed(_ring, size, count == 0 && _chunk->size != 0);
+
+    return size;
+}
+
+size_t spscring_write_acquire(const spscring_t *const _ring, spscring_span_t *const _span)
+{
+    const size_t head = _ring->head.load(std::memory_order_relaxed);
+    const size_t space = _ring->chunk.size - (head - _ring->tail.load(std::memory_order_acquire));
+
+    split(_ring, head, space, _span);
+
+    return space;
+}
+
+void spscring_write_commit(spscring_t *const _ring, const size_t _count)
+{
+    const size_t head = _ring->head.load(std::memory_order_relaxed);
+    const size_t space = _ring->chunk.size - (head - _ring->tail.load(std::memory_order_acquire));
+
+    const size_t size = (_count < space) ? _count : space;
+
+    _ring->head.store(head + size, std::memory_order_release);
+    produced(_ring, _ring->chunk.size - space + size, size, _count - size);
+}
+
+size_t spscring_read_acquire(const spscring_t *const _ring, spscring_span_t *const _span)
+{
+    const size_t tail = _ring->tail.load(std::memory_order_relaxed);
+    const size_t count = _ring->head.load(std::memory_order_acquire) - tail;
+
+    split(_ring, tail, count, _span);
+
+    return count;
+}
+
+void spscring_read_commit(spscring_t *const _ring, const size_t _count)
+{
+    const size_t tail = _ring->tail.load(std::memory_order_relaxed);
+    const size_t count = _ring->head.load(std::memory_order_acquire) - tail;
+
+    const size_t size = (_count < count) ? _count : count;
+
+    _ring->tail.store(tail + size, std::memory_order_release);
+    consumed(_ring, size, false);
+}
+
+size_t spscring_copy(spscring_t *const _source, spscring_t *const _destination)
+{
+    spscring_span_t from;
+    spscring_span_t to;
+
+    const size_t count = spscring_read_acquire(_source, &from);
+    const size_t space = spscring_write_acquire(_destination, &to);
+    const size_t size = (count < space) ? count : space;
+
+    /* at most two source and two destination pieces, so at most three block copies */
+    size_t done = 0;
+    size_t f = 0;
+    size_t t = 0;
+    size_t f_offset = 0;
+    size_t t_offset = 0;
+
+    while (done < size)
+    {
+        const size_t f_rest = from.piece[f].size - f_offset;
+        const size_t t_rest = to.piece[t].size - t_offset;
+        size_t step = (f_rest < t_rest) ? f_rest : t_rest;
+        step = (step < size - done) ? step : size - done;
+
+        memcpy(&to.piece[t].space[t_offset], &from.piece[f].space[f_offset], step);
+        done += step;
+
+        f_offset += step;
+        if (f_offset == from.piece[f].size)
+        {
+            f++;
+            f_offset = 0;
+        }
+
+        t_offset += step;
+        if (t_offset == to.piece[t].size)
+        {
+            t++;
+            t_offset = 0;
+        }
+    }
+
+    spscring_write_commit(_destination, size);
+    spscring_read_commit(_source, size);
+
+    return size;
+}
+
+void spscring_statistics(const spscring_t *const _ring, spscring_statistics_t *const _statistics)
+{
+#if SPSCRING_STATISTICS
+    _statistics->peak = _ring->statistics.peak.load(std::memory_order_relaxed);
+    _statistics->overflows = _ring->statistics.overflows.load(std::memory_order_relaxed);
+    _statistics->rejected = _ring->statistics.rejected.load(std::memory_order_relaxed);
+    _statistics->written = _ring->statistics.written.load(std::memory_order_relaxed);
+    _statistics->underruns = _ring->statistics.underruns.load(std::memory_order_relaxed);
+    _statistics->read = _ring->statistics.read.load(std::memory_order_relaxed);
+#else
+    (void)_ring;
+    *_statistics = spscring_statistics_t{};
+#endif
+}
+
+void spscring_statistics_reset(spscring_t *const _ring)
+{
+#if SPSCRING_STATISTICS
+    _ring->statistics.peak.store(0, std::memory_order_relaxed);
+    _ring->statistics.overflows.store(0, std::memory_order_relaxed);
+    _ring->statistics.rejected.store(0, std::memory_order_relaxed);
+    _ring->statistics.written.store(0, std::memory_order_relaxed);
+    _ring->statistics.underruns.store(0, std::memory_order_relaxed);
+    _ring->statistics.read.store(0, std::memory_order_relaxed);
+#else
+    (void)_ring;
+#endif
+}
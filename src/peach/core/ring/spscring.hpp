@@ -0,0 +1,118 @@
+/**
+ * \file spscring.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SPSCRING_STATISTICS
+#define SPSCRING_STATISTICS 0
+#endif
+
+/**
+ * \brief Ring usage counters, compiled in with SPSCRING_STATISTICS.
+ *
+ * Every counter has a single writer: peak, overflows, rejected and written
+ * belong to the producer, underruns and read to the consumer.
+ */
+typedef struct
+{
+    uint32_t peak;      // highest fill level seen after a write
+    uint32_t overflows; // writes which did not fit completely
+    uint32_t rejected;  // bytes dropped by those writes
+    uint32_t written;   // bytes accepted in total
+    uint32_t underruns; // reads on an empty ring
+    uint32_t read;      // bytes consumed in total
+} spscring_statistics_t;
+
+/**
+ * \brief Lock free single producer, single consumer byte ring.
+ *
+ * One side (e.g. an interrupt handler or core1) only pushes, the other side
+ * only pops, neither needs to disable interrupts. Head and tail are free
+ * running indices, the storage size must be a power of two so that the
+ * position is a mask instead of a division.
+ *
+ * Ordering: the producer writes the data before it publishes the new head
+ * with release semantics, the consumer loads the head with acquire semantics
+ * before it reads the data. Tail is handed back the same way. On RP2040 the
+ * loads and stores are plain word accesses with a barrier, no locks.
+ *
+ * Producer side: spscring_push, spscring_write, spscring_space,
+ * spscring_write_acquire/commit.
+ * Consumer side: spscring_pop, spscring_read, spscring_peek, spscring_count,
+ * spscring_read_acquire/commit.
+ */
+typedef struct
+{
+    chunk_t chunk;
+    size_t mask;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+#if SPSCRING_STATISTICS
+    struct
+    {
+        std::atomic<uint32_t> peak;
+        std::atomic<uint32_t> overflows;
+        std::atomic<uint32_t> rejected;
+        std::atomic<uint32_t> written;
+        std::atomic<uint32_t> underruns;
+        std::atomic<uint32_t> read;
+    } statistics;
+#endif
+} spscring_t;
+
+/**
+ * \brief Ring region as at most two contiguous pieces of the ring memory.
+ *
+ * The second piece is only used if the region wraps around the end of the
+ * storage, otherwise its size is zero. Both pieces in order form the region,
+ * so the array can be handed to sequence functions like
+ * checksum_update_sequence directly. An acquired region stays valid until
+ * its owner commits, the other side never touches it in the meantime.
+ */
+typedef struct
+{
+    chunk_t piece[2];
+} spscring_span_t;
+
+bool spscring_init(spscring_t *const _ring, const chunk_t _chunk);
+void spscring_reset(spscring_t *const _ring);
+
+size_t spscring_capacity(const spscring_t *const _ring);
+size_t spscring_count(const spscring_t *const _ring);
+size_t spscring_space(const spscring_t *const _ring);
+bool spscring_is_empty(const spscring_t *const _ring);
+bool spscring_is_full(const spscring_t *const _ring);
+
+bool spscring_push(spscring_t *const _ring, const uint8_t _value);
+size_t spscring_write(spscring_t *const _ring, const chunk_t *const _chunk);
+
+bool spscring_pop(spscring_t *const _ring, uint8_t *const _value);
+bool spscring_peek(const spscring_t *const _ring, const size_t _index, uint8_t *const _value);
+size_t spscring_read(spscring_t *const _ring, chunk_t *const _chunk);
+
+/* moves as many bytes as the destination takes, the rest stays in the source */
+size_t spscring_copy(spscring_t *const _source, spscring_t *const _destination);
+
+/* zero copy access, parsers and DMA work directly in the ring memory */
+size_t spscring_write_acquire(const spscring_t *const _ring, spscring_span_t *const _span);
+void spscring_write_commit(spscring_t *const _ring, const size_t _count);
+size_t spscring_read_acquire(const spscring_t *const _ring, spscring_span_t *const _span);
+void spscring_read_commit(spscring_t *const _ring, const size_t _count);
+
+/*
+    counter snapshot (all zero without SPSCRING_STATISTICS), the reset is
+    only exact while both sides are idle
+*/
+void spscring_statistics(const spscring_t *const _ring, spscring_statistics_t *const _statistics);
+void spscring_statistics_reset(spscring_t *const _ring);
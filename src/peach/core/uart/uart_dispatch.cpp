@@ -0,0 +1,83 @@
+/**
+ * \file uart_dispatch.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "uart_dispatch.hpp"
+
+#include <string.h>
+
+namespace core::driver::uart
+{
+    Dispatcher::Dispatcher(const dispatch_t &_policy) :
+        policy(_policy)
+    {
+    }
+
+    void Dispatcher::reset()
+    {
+        last_receive = 0;
+        idle = true;
+        calls = 0;
+        saved = 0;
+    }
+
+    bool Dispatcher::contains_delimiter(const spscring_t *const _rx, const size_t _received) const
+    {
+        /* only the bytes of this update, the unread span ends with them */
+        spscring_span_t span;
+        const size_t count = spscring_read_acquire(_rx, &span);
+        size_t skip = count > _received ? count - _received : 0;
+
+        for (const chunk_t &piece : span.piece)
+        {
+            if (skip >= piece.size)
+            {
+                skip -= piece.size;
+                continue;
+            }
+            if (memchr(piece.space + skip, policy.delimiter, piece.size - skip))
+            {
+                return true;
+            }
+            skip = 0;
+        }
+        return false;
+    }
+
+    bool Dispatcher::update(const spscring_t *const _rx, const size_t _received, const uint64_t _now)
+    {
+        bool due = false;
+
+        if (_received)
+        {
+            last_receive = _now;
+            idle = false;
+
+            due = (policy.threshold && spscring_count(_rx) >= policy.threshold) ||
+                  (policy.delimiter != NO_DELIMITER && contains_delimiter(_rx, _received));
+        }
+        else if (!idle && _now - last_receive >= policy.timeout_us)
+        {
+            idle = true;
+            due = policy.timeout_us && !spscring_is_empty(_rx);
+        }
+
+        /* never let the producer run into a handler that waits for more */
+        due = due || spscring_count(_rx) >= spscring_capacity(_rx) / 2;
+
+        if (due)
+        {
+            calls++;
+        }
+        else
+        {
+            saved++;
+        }
+
+        return due;
+    }
+}
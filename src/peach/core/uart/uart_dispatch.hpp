@@ -0,0 +1,65 @@
+/**
+ * \file uart_dispatch.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "spscring.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::uart
+{
+    typedef void (*ring_handler_t)(spscring_t *const _rx, spscring_t *const _tx);
+    typedef uint64_t (*clock_source_t)(void);
+
+    static const int16_t NO_DELIMITER = -1;
+
+    /*
+        a handler call is due if one of the enabled conditions holds:
+        - threshold:  at least threshold bytes are pending (0 disables)
+        - delimiter:  the delimiter byte arrived (NO_DELIMITER disables)
+        - timeout_us: the line was quiet for timeout_us after the last byte (0 disables)
+    */
+    struct dispatch_t
+    {
+        size_t threshold;
+        int16_t delimiter;
+        uint32_t timeout_us;
+    };
+
+    /**
+     * \brief Decides per perform() whether the (rx, tx) handler has to run.
+     *
+     * Threshold and delimiter are only evaluated when new bytes arrived, the
+     * timeout fires once per quiet period, so a handler that leaves bytes in
+     * the ring is not called over and over again. A half full ring is always
+     * due. Every update without a handler call counts as a saved call.
+     */
+    class Dispatcher
+    {
+      public:
+        explicit Dispatcher(const dispatch_t &_policy);
+
+        void reset();
+        bool update(const spscring_t *const _rx, const size_t _received, const uint64_t _now);
+
+        bool is_idle() const { return idle; }
+        uint32_t get_calls() const { return calls; }
+        uint32_t get_saved() const { return saved; }
+
+      private:
+        bool contains_delimiter(const spscring_t *const _rx, const size_t _received) const;
+
+        const dispatch_t policy;
+        uint64_t last_receive = 0;
+        bool idle = true;
+        uint32_t calls = 0;
+        uint32_t saved = 0;
+    };
+}
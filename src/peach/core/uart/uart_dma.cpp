@@ -0,0 +1,280 @@
+/**
+ * \file uart_dma.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "uart_dma.hpp"
+
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <pico/stdlib.h>
+
+namespace core::driver::uart
+{
+    namespace
+    {
+        uint ring_bits(const size_t _size)
+        {
+            uint bits = 0;
+            while ((static_cast<size_t>(1) << bits) < _size)
+            {
+                bits++;
+            }
+            return bits;
+        }
+
+        static const uint32_t ERROR_BITS = UART_UARTRIS_OERIS_BITS | UART_UARTRIS_BERIS_BITS | UART_UARTRIS_PERIS_BITS | UART_UARTRIS_FERIS_BITS;
+
+        /* uart function of a gpio: 0 tx, 1 rx, 2 cts, 3 rts, the instance alternates in blocks of four pins */
+        bool has_function(uart_inst_t *const _uart, const uint _pin, const uint _function)
+        {
+            return _pin < NUM_BANK0_GPIOS && (_pin & 3) == _function && (((_pin >> 3) ^ (_pin >> 2)) & 1) == uart_get_index(_uart);
+        }
+    }
+
+    DmaDevice::DmaDevice(const config_t &_config) :
+        config(_config),
+        dispatcher(_config.dispatch)
+    {
+    }
+
+    void DmaDevice::initialize()
+    {
+        const uintptr_t alignment = reinterpret_cast<uintptr_t>(config.rx_space.space) & (config.rx_space.size - 1);
+        if (!spscring_init(&rx, config.rx_space) || !spscring_init(&tx, config.tx_space) || alignment != 0)
+        {
+            return;
+        }
+
+        baudrate = uart_init(config.uart, config.baudrate);
+        gpio_set_function(config.tx_pin, GPIO_FUNC_UART);
+        gpio_set_function(config.rx_pin, GPIO_FUNC_UART);
+        uart_set_fifo_enabled(config.uart, true);
+
+        flow_control = has_function(config.uart, config.cts_pin, 2) && has_function(config.uart, config.rts_pin, 3);
+        if (flow_control)
+        {
+            gpio_set_function(config.cts_pin, GPIO_FUNC_UART);
+            gpio_set_function(config.rts_pin, GPIO_FUNC_UART);
+        }
+        uart_set_hw_flow(config.uart, flow_control, flow_control);
+
+        rx_channel = dma_claim_unused_channel(false);
+        reload_channel = dma_claim_unused_channel(false);
+        tx_channel = dma_claim_unused_channel(false);
+
+        if (rx_channel < 0 || reload_channel < 0 || tx_channel < 0)
+        {
+            shutdown();
+            return;
+        }
+
+        const uint rx_dma = static_cast<uint>(rx_channel);
+        const uint reload_dma = static_cast<uint>(reload_channel);
+
+        /* reload channel restarts the receiver once its transfer count ran out, not used with flow control */
+        dma_channel_config reload_config = dma_channel_get_default_config(reload_dma);
+        channel_config_set_transfer_data_size(&reload_config, DMA_SIZE_32);
+        channel_config_set_read_increment(&reload_config, false);
+        channel_config_set_write_increment(&reload_config, false);
+        dma_channel_configure(reload_dma, &reload_config, &dma_hw->ch[rx_dma].al1_transfer_count_trig, &reload_count, 1, false);
+
+        dma_channel_config rx_config = dma_channel_get_default_config(rx_dma);
+        channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, true);
+        channel_config_set_ring(&rx_config, true, ring_bits(config.rx_space.size));
+        channel_config_set_dreq(&rx_config, uart_get_dreq(config.uart, false));
+        channel_config_set_chain_to(&rx_config, flow_control ? rx_dma : reload_dma);
+
+        /* with flow control the receiver only gets the free space of the ring, see grant() */
+        rx_remaining = flow_control ? static_cast<uint32_t>(spscring_space(&rx)) : reload_count;
+        dma_channel_configure(rx_dma, &rx_config, config.rx_space.space, &uart_get_hw(config.uart)->dr, rx_remaining, true);
+
+        skipped = 0;
+        overflowed = false;
+        tx_pending = 0;
+        overflows = 0;
+        lost = 0;
+        errors = 0;
+        uart_get_hw(config.uart)->icr = ERROR_BITS;
+        dispatcher.reset();
+    }
+
+    void DmaDevice::shutdown()
+    {
+        if (rx_channel >= 0)
+        {
+            /* unchain first, otherwise the abort may trigger the reload channel (RP2040-E13) */
+            const uint rx_dma = static_cast<uint>(rx_channel);
+            hw_write_masked(&dma_hw->ch[rx_dma].al1_ctrl, rx_dma << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB, DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+            dma_channel_abort(rx_dma);
+            dma_channel_unclaim(static_cast<uint>(rx_channel));
+            rx_channel = -1;
+        }
+        if (reload_channel >= 0)
+        {
+            dma_channel_abort(static_cast<uint>(reload_channel));
+            dma_channel_unclaim(static_cast<uint>(reload_channel));
+            reload_channel = -1;
+        }
+        if (tx_channel >= 0)
+        {
+            dma_channel_abort(static_cast<uint>(tx_channel));
+            dma_channel_unclaim(static_cast<uint>(tx_channel));
+            tx_channel = -1;
+        }
+
+        uart_deinit(config.uart);
+    }
+
+    void DmaDevice::set_baudrate(const uint _baudrate)
+    {
+        if (tx_channel >= 0)
+        {
+            /* let the line run dry, a rate change in the middle of a byte garbles it */
+            dma_channel_wait_for_finish_blocking(static_cast<uint>(tx_channel));
+            uart_tx_wait_blocking(config.uart);
+        }
+        baudrate = uart_set_baudrate(config.uart, _baudrate);
+    }
+
+    uint32_t DmaDevice::dma_received()
+    {
+        /* the reload channel sets the count back to reload_count once it ran out */
+        const uint32_t remaining = dma_hw->ch[static_cast<uint>(rx_channel)].transfer_count;
+        const uint32_t result = remaining <= rx_remaining ? rx_remaining - remaining : rx_remaining + (reload_count - remaining);
+        rx_remaining = remaining;
+        return result;
+    }
+
+    size_t DmaDevice::receive()
+    {
+        uart_hw_t *const hw = uart_get_hw(config.uart);
+        const uint32_t flags = hw->ris & ERROR_BITS;
+        if (flags)
+        {
+            errors += static_cast<uint32_t>(__builtin_popcount(flags));
+            hw->icr = flags;
+        }
+
+        /* look before counting, a grant that ran out is complete */
+        const bool exhausted = flow_control && !dma_channel_is_busy(static_cast<uint>(rx_channel));
+        const size_t received = dma_received();
+
+        if (overflowed)
+        {
+            /* the consumer did not drop the old data yet, everything new is skipped with it */
+            skipped += received;
+            return 0;
+        }
+
+        if (received > spscring_space(&rx))
+        {
+            /* the DMA overwrote unread data, possibly more than one lap of the ring */
+            overflowed = true;
+            overflows++;
+            skipped = received;
+            return 0;
+        }
+
+        if (received)
+        {
+            spscring_write_commit(&rx, received);
+        }
+        if (exhausted)
+        {
+            grant();
+        }
+        return received;
+    }
+
+    void DmaDevice::grant()
+    {
+        /* nothing to grant while the ring is full, the next perform() looks again */
+        const uint32_t space = static_cast<uint32_t>(spscring_space(&rx));
+        if (space)
+        {
+            rx_remaining = space;
+            dma_channel_set_trans_count(static_cast<uint>(rx_channel), space, true);
+        }
+    }
+
+    void DmaDevice::discard()
+    {
+        /* consumer side: the unread data is garbage now */
+        const size_t unread = spscring_count(&rx);
+        spscring_read_commit(&rx, unread);
+        lost += static_cast<uint32_t>(unread + skipped);
+
+        /* step over what the DMA wrote meanwhile, the ring index stays on the DMA position */
+        const size_t capacity = spscring_capacity(&rx);
+        while (skipped)
+        {
+            const size_t step = skipped < capacity ? skipped : capacity;
+            spscring_write_commit(&rx, step);
+            spscring_read_commit(&rx, step);
+            skipped -= step;
+        }
+
+        overflowed = false;
+        dispatcher.reset();
+    }
+
+    void DmaDevice::transmit()
+    {
+        const uint tx_dma = static_cast<uint>(tx_channel);
+
+        if (tx_pending)
+        {
+            if (dma_channel_is_busy(tx_dma))
+            {
+                return;
+            }
+            spscring_read_commit(&tx, tx_pending);
+            tx_pending = 0;
+        }
+
+        spscring_span_t span;
+        if (spscring_read_acquire(&tx, &span) == 0)
+        {
+            return;
+        }
+
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_dma);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_dreq(&tx_config, uart_get_dreq(config.uart, true));
+
+        tx_pending = span.piece[0].size;
+        dma_channel_configure(tx_dma, &tx_config, &uart_get_hw(config.uart)->dr, span.piece[0].space, static_cast<uint>(tx_pending), true);
+    }
+
+    void DmaDevice::perform()
+    {
+        if (rx_channel < 0)
+        {
+            return;
+        }
+
+        const size_t received = receive();
+
+        /* between handler calls, no span of the consumer is open */
+        if (overflowed)
+        {
+            discard();
+            return;
+        }
+
+        if (dispatcher.update(&rx, received, time_us_64()) && handler)
+        {
+            handler(&rx, &tx);
+        }
+
+        transmit();
+    }
+}
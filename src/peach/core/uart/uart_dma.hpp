@@ -0,0 +1,127 @@
+/**
+ * \file uart_dma.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+#include "spscring.hpp"
+#include "uart_dispatch.hpp"
+
+#include <hardware/uart.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::uart
+{
+    /**
+     * \brief DMA driven uart with the (rx, tx) handler contract of the uart variants.
+     *
+     * Receive: a DMA channel in ring mode streams the uart data register into
+     * the rx ring memory without any cpu involvement, a second channel reloads
+     * its transfer count so reception never stops. perform() only publishes
+     * the new bytes and calls the handler when the dispatch policy says so.
+     * The bytes are counted from the transfer count of the DMA, which is free
+     * running, so a whole lap of the ring between two calls is seen as well.
+     *
+     * The DMA does not wait for the consumer, it writes ahead into the free
+     * part of the ring. If more bytes arrive than the ring has space for, the
+     * unread data is overwritten: receive() then publishes nothing and only
+     * flags the overflow, perform() drops the unread data on behalf of the
+     * consumer before the next handler call and continues with the bytes
+     * after the loss (get_overflows(), get_lost()). So a span taken with
+     * spscring_read_acquire() must be committed before the handler returns,
+     * the ring memory behind it is not protected across calls.
+     *
+     * Transmit: whatever the handler put into the tx ring is handed to a
+     * DMA channel in one contiguous piece per transfer.
+     *
+     * RTS/CTS flow control is enabled if both pins are given and carry the
+     * CTS and RTS function of this uart, otherwise the pins are ignored.
+     * RTS follows the uart fifo, a free running DMA keeps the fifo empty
+     * and RTS would never hold the peer back. So with flow control the
+     * receiver is not reloaded, perform() grants it the free space of the
+     * ring whenever it ran out (grant()). While the ring is full the fifo
+     * fills up, RTS deasserts and the data waits at the peer; the ring
+     * never overflows.
+     *
+     * get_errors() counts the framing, parity, break and overrun events
+     * the uart flagged, one per kind and perform() call at most.
+     *
+     * The rx storage size must be a power of two and the storage must be
+     * aligned to its size (DMA ring mode), e.g. alignas(1024) uint8_t[1024].
+     */
+    class DmaDevice
+    {
+      public:
+        static const uint NO_PIN = 0xff;
+
+        struct config_t
+        {
+            uart_inst_t *uart;
+            uint tx_pin;
+            uint rx_pin;
+            uint baudrate;
+            dispatch_t dispatch;
+            chunk_t rx_space;
+            chunk_t tx_space;
+            uint cts_pin = NO_PIN;
+            uint rts_pin = NO_PIN;
+        };
+
+        explicit DmaDevice(const config_t &_config);
+
+        void initialize();
+        void perform();
+        void shutdown();
+
+        void set_handler(ring_handler_t _handler) { handler = _handler; }
+
+        spscring_t *get_rx() { return &rx; }
+        spscring_t *get_tx() { return &tx; }
+
+        void set_baudrate(const uint _baudrate);
+
+        uint get_baudrate() const { return baudrate; }
+        bool has_flow_control() const { return flow_control; }
+        bool is_idle() const { return dispatcher.is_idle(); }
+        uint32_t get_overflows() const { return overflows; }
+        uint32_t get_lost() const { return lost; }
+        uint32_t get_errors() const { return errors; }
+        uint32_t get_calls() const { return dispatcher.get_calls(); }
+        uint32_t get_saved() const { return dispatcher.get_saved(); }
+
+      protected:
+        uint32_t dma_received();
+        size_t receive();
+        void grant();
+        void discard();
+        void transmit();
+
+        const config_t config;
+        ring_handler_t handler = nullptr;
+        Dispatcher dispatcher;
+
+        spscring_t rx;
+        spscring_t tx;
+
+        int rx_channel = -1;
+        int reload_channel = -1;
+        int tx_channel = -1;
+
+        uint32_t reload_count = 0xffffffff;
+        uint32_t rx_remaining = 0;
+        size_t skipped = 0;
+        bool overflowed = false;
+        size_t tx_pending = 0;
+        uint baudrate = 0;
+        bool flow_control = false;
+        uint32_t overflows = 0;
+        uint32_t lost = 0;
+        uint32_t errors = 0;
+    };
+}
@@ -0,0 +1,317 @@
+/**
+ * \file uart_negotiation.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include "spscring.hpp"
+#include "uart_dispatch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::uart
+{
+    enum class negotiation_t
+    {
+        IDLE,
+        OFFERING,
+        VERIFYING,
+        LINKED,
+        FALLBACK,
+    };
+
+    struct negotiation_config_t
+    {
+        const uint32_t *rates;
+        size_t count;
+        uint32_t default_rate;
+        uint32_t retry_us;
+        uint32_t timeout_us;
+        uint32_t probes;
+        uint32_t error_limit;
+        clock_source_t clock;
+    };
+
+    /**
+     * \brief Agrees with the peer on the fastest common baudrate.
+     *
+     * Both ends run the same state machine at the default rate, messages
+     * are packets (see core::packet):
+     *
+     * - OFFERING:  send OFFER(rates) every retry_us, answer every received
+     *              OFFER with ACCEPT(fastest common rate). Once the peer
+     *              offer is known and the peer accepted the same rate,
+     *              switch the rate. An ACCEPT of another rate (a stale
+     *              answer, an offer that changed) starts the round over.
+     * - VERIFYING: send PROBE(number of peer probes seen) every retry_us at
+     *              the new rate. LINKED once probes PROBE packets of the
+     *              peer arrived and the peer reports the same, the last
+     *              PROBE tells the peer. An end that switched late misses
+     *              the first probes of the peer, the count keeps the
+     *              early one probing until both ends are through.
+     * - FALLBACK:  any phase that takes longer than timeout_us goes back to
+     *              the default rate, so does a LINKED link whose error
+     *              counter grows by more than error_limit (see supervise()).
+     *
+     * A link that falls back has no way to tell the peer, the peer still
+     * runs at the fast rate and cannot read anything sent at the default
+     * rate. So both ends must supervise their own receive errors (framing,
+     * get_errors() of the device): once one end falls back, everything it
+     * sends garbles at the other end, whose counter then trips as well.
+     *
+     * The negotiator reads the rx ring itself, the device handler must stay
+     * unset until is_done(). DEVICE is DmaDevice or SimulatedDevice.
+     */
+    template <typename DEVICE>
+    class Negotiator
+    {
+      public:
+        static const size_t MAX_RATES = 8;
+
+        Negotiator(DEVICE &_device, const negotiation_config_t &_config) :
+            device(_device),
+            config(_config)
+        {
+        }
+
+        void start()
+        {
+            device.set_baudrate(config.default_rate);
+            state = negotiation_t::OFFERING;
+            started = config.clock();
+            last_send = started - config.retry_us;
+            chosen = 0;
+            peer_rate = 0;
+            probes = 0;
+            peer_probes = 0;
+            supervised = false;
+        }
+
+        void perform()
+        {
+            const uint64_t now = config.clock();
+
+            spscring_span_t payload;
+            while (receiver.receive(device.get_rx(), &payload))
+            {
+                uint8_t message[1 + 4 * MAX_RATES];
+                size_t size = 0;
+                for (const chunk_t &piece : payload.piece)
+                {
+                    for (size_t i = 0; i < piece.size && size < sizeof(message); ++i)
+                    {
+                        message[size++] = piece.space[i];
+                    }
+                }
+                receiver.release(device.get_rx());
+
+                handle(message, size);
+            }
+
+            switch (state)
+            {
+                case negotiation_t::OFFERING:
+                    if (chosen && peer_rate && chosen != peer_rate)
+                    {
+                        /* both ends must have computed the same rate, ask for a fresh answer */
+                        peer_rate = 0;
+                        send_offer();
+                        last_send = now;
+                    }
+                    else if (chosen && peer_rate)
+                    {
+                        if (!spscring_is_empty(device.get_tx()))
+                        {
+                            /* the last ACCEPT is still on its way at the old rate */
+                            break;
+                        }
+                        if (chosen == config.default_rate)
+                        {
+                            state = negotiation_t::LINKED;
+                            break;
+                        }
+                        device.set_baudrate(chosen);
+                        state = negotiation_t::VERIFYING;
+                        started = now;
+                        last_send = now - config.retry_us;
+                    }
+                    else if (now - started >= config.timeout_us)
+                    {
+                        fall_back();
+                    }
+                    else if (now - last_send >= config.retry_us)
+                    {
+                        send_offer();
+                        last_send = now;
+                    }
+                    break;
+
+                case negotiation_t::VERIFYING:
+                    if (probes >= config.probes && peer_probes >= config.probes)
+                    {
+                        send(PROBE, probes);
+                        state = negotiation_t::LINKED;
+                    }
+                    else if (now - started >= config.timeout_us)
+                    {
+                        fall_back();
+                    }
+                    else if (now - last_send >= config.retry_us)
+                    {
+                        send(PROBE, probes);
+                        last_send = now;
+                    }
+                    break;
+
+                case negotiation_t::IDLE:
+                case negotiation_t::LINKED:
+                case negotiation_t::FALLBACK:
+                    break;
+            }
+        }
+
+        /**
+         * \brief Watches an error counter of the running link.
+         *
+         * Call it on both ends with the receive error counter of the own
+         * device, the first call on a LINKED link takes the base.
+         *
+         * \return true if the link fell back to the default rate
+         */
+        bool supervise(const uint32_t _errors)
+        {
+            if (state != negotiation_t::LINKED || chosen == config.default_rate)
+            {
+                return false;
+            }
+
+            if (!supervised)
+            {
+                error_base = _errors;
+                supervised = true;
+            }
+
+            if (_errors - error_base > config.error_limit)
+            {
+                fall_back();
+                return true;
+            }
+            return false;
+        }
+
+        bool is_done() const { return state == negotiation_t::LINKED || state == negotiation_t::FALLBACK; }
+        negotiation_t get_state() const { return state; }
+        uint32_t get_rate() const { return device.get_baudrate(); }
+        uint32_t get_errors() const { return receiver.get_errors(); }
+
+      private:
+        enum : uint8_t
+        {
+            OFFER = 'O',
+            ACCEPT = 'A',
+            PROBE = 'P',
+        };
+
+        static uint32_t read(const uint8_t *const _space)
+        {
+            return static_cast<uint32_t>(_space[0]) | static_cast<uint32_t>(_space[1]) << 8 | static_cast<uint32_t>(_space[2]) << 16 |
+                   static_cast<uint32_t>(_space[3]) << 24;
+        }
+
+        static void write(uint8_t *const _space, const uint32_t _value)
+        {
+            _space[0] = static_cast<uint8_t>(_value);
+            _space[1] = static_cast<uint8_t>(_value >> 8);
+            _space[2] = static_cast<uint8_t>(_value >> 16);
+            _space[3] = static_cast<uint8_t>(_value >> 24);
+        }
+
+        bool supports(const uint32_t _rate) const
+        {
+            for (size_t i = 0; i < config.count; ++i)
+            {
+                if (config.rates[i] == _rate)
+                {
+                    return true;
+                }
+            }
+            return _rate == config.default_rate;
+        }
+
+        void send(const uint8_t _type, const uint32_t _rate)
+        {
+            uint8_t message[5] = {_type};
+            write(&message[1], _rate);
+            const chunk_t chunk = {message, sizeof(message)};
+            core::packet::transmit(device.get_tx(), &chunk);
+        }
+
+        void send_offer()
+        {
+            uint8_t message[1 + 4 * MAX_RATES] = {OFFER};
+            const size_t count = config.count < MAX_RATES ? config.count : MAX_RATES;
+            for (size_t i = 0; i < count; ++i)
+            {
+                write(&message[1 + 4 * i], config.rates[i]);
+            }
+            const chunk_t chunk = {message, 1 + 4 * count};
+            core::packet::transmit(device.get_tx(), &chunk);
+        }
+
+        void handle(const uint8_t *const _message, const size_t _size)
+        {
+            if (_size == 0)
+            {
+                return;
+            }
+
+            if (_message[0] == OFFER && state == negotiation_t::OFFERING)
+            {
+                uint32_t best = config.default_rate;
+                for (size_t i = 1; i + 4 <= _size; i += 4)
+                {
+                    const uint32_t rate = read(&_message[i]);
+                    best = (rate > best && supports(rate)) ? rate : best;
+                }
+                chosen = best;
+                send(ACCEPT, chosen);
+            }
+            else if (_message[0] == ACCEPT && _size == 5 && state == negotiation_t::OFFERING)
+            {
+                /* the peer knows our offer, perform() compares its rate with ours */
+                peer_rate = read(&_message[1]);
+            }
+            else if (_message[0] == PROBE && state == negotiation_t::VERIFYING)
+            {
+                probes++;
+                peer_probes = _size == 5 ? read(&_message[1]) : 0;
+            }
+        }
+
+        void fall_back()
+        {
+            device.set_baudrate(config.default_rate);
+            state = negotiation_t::FALLBACK;
+        }
+
+        DEVICE &device;
+        const negotiation_config_t config;
+        core::packet::Receiver receiver;
+
+        negotiation_t state = negotiation_t::IDLE;
+        uint64_t started = 0;
+        uint64_t last_send = 0;
+        uint32_t chosen = 0;
+        uint32_t peer_rate = 0;
+        uint32_t probes = 0;
+        uint32_t peer_probes = 0;
+        uint32_t error_base = 0;
+        bool supervised = false;
+    };
+}
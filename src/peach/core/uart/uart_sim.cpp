@@ -0,0 +1,156 @@
+/**
+ * \file uart_sim.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "uart_sim.hpp"
+
+namespace core::driver::uart
+{
+    namespace
+    {
+        /* start and stop bit around the data byte */
+        static const uint64_t BITS_PER_BYTE = 10;
+        static const uint64_t MICROSECONDS = 1000000;
+    }
+
+    SimulatedDevice::SimulatedDevice(const config_t &_config) :
+        config(_config),
+        dispatcher(_config.dispatch)
+    {
+    }
+
+    void SimulatedDevice::initialize()
+    {
+        if (!spscring_init(&rx, config.rx_space) || !spscring_init(&tx, config.tx_space) || !config.clock || !config.baudrate)
+        {
+            return;
+        }
+
+        statistics = sim_statistics_t{};
+        set_baudrate(config.baudrate);
+        dispatcher.reset();
+        last_transmit = config.clock();
+        credit = 0;
+        arrived = 0;
+        random = config.seed;
+        active = true;
+    }
+
+    void SimulatedDevice::set_baudrate(const uint32_t _baudrate)
+    {
+        baudrate = _baudrate;
+        loss_ppm = config.loss_model ? config.loss_model(_baudrate) : config.loss_ppm;
+        credit = 0;
+    }
+
+    void SimulatedDevice::shutdown()
+    {
+        active = false;
+    }
+
+    bool SimulatedDevice::lose()
+    {
+        if (loss_ppm == 0)
+        {
+            return false;
+        }
+
+        random = random * 1664525u + 1013904223u;
+        return (random >> 8) % MICROSECONDS < loss_ppm;
+    }
+
+    void SimulatedDevice::deliver(const uint8_t _value, const uint64_t _now)
+    {
+        if (!spscring_push(&rx, _value))
+        {
+            statistics.overflows++;
+            return;
+        }
+
+        if (spscring_count(&rx) == 1)
+        {
+            oldest = _now;
+        }
+        statistics.delivered++;
+        arrived++;
+    }
+
+    void SimulatedDevice::transmit(const uint64_t _now)
+    {
+        if (spscring_is_empty(&tx))
+        {
+            /* an idle line does not save up bits for later */
+            credit = 0;
+            last_transmit = _now;
+            return;
+        }
+
+        credit += (_now - last_transmit) * baudrate;
+        last_transmit = _now;
+
+        uint8_t value;
+        while (credit >= BITS_PER_BYTE * MICROSECONDS)
+        {
+            if ((config.flow_control && spscring_is_full(&peer->rx)) || !spscring_pop(&tx, &value))
+            {
+                /* tx drained or CTS deasserted, the line stalls */
+                credit = 0;
+                break;
+            }
+
+            credit -= BITS_PER_BYTE * MICROSECONDS;
+            statistics.sent++;
+
+            if (lose())
+            {
+                peer->statistics.lost++;
+            }
+            else if (baudrate != peer->baudrate)
+            {
+                /* the receiver samples at the wrong rate, the stop bit rarely fits */
+                random = random * 1664525u + 1013904223u;
+                peer->statistics.errors++;
+                peer->deliver(value ^ static_cast<uint8_t>((random >> 16) | 1), _now);
+            }
+            else
+            {
+                peer->deliver(value, _now);
+            }
+        }
+    }
+
+    void SimulatedDevice::perform()
+    {
+        if (!active || !peer)
+        {
+            return;
+        }
+
+        const uint64_t now = config.clock();
+
+        const size_t received = arrived;
+        arrived = 0;
+
+        if (dispatcher.update(&rx, received, now) && handler)
+        {
+            if (!spscring_is_empty(&rx))
+            {
+                const uint32_t latency = static_cast<uint32_t>(now - oldest);
+                statistics.latency_max = latency > statistics.latency_max ? latency : statistics.latency_max;
+                statistics.latency_sum += latency;
+                statistics.latency_count++;
+            }
+
+            handler(&rx, &tx);
+
+            /* what the handler left behind waits from now on */
+            oldest = now;
+        }
+
+        transmit(now);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * \file uart_sim.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+#include "spscring.hpp"
+#include "uart_dispatch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core::driver::uart
+{
+    /* line error rate in ppm for a baudrate */
+    typedef uint32_t (*loss_model_t)(const uint32_t _baudrate);
+
+    struct sim_statistics_t
+    {
+        uint32_t sent;
+        uint32_t delivered;
+        uint32_t lost;
+        uint32_t overflows;
+        uint32_t errors;
+        uint32_t latency_max;
+        uint64_t latency_sum;
+        uint32_t latency_count;
+    };
+
+    /**
+     * \brief In-process uart with the (rx, tx) handler contract of DmaDevice.
+     *
+     * Two connected devices form a null modem cable: perform() moves the tx
+     * ring content onto the peer rx ring at the pace of the baudrate (10 bits
+     * per byte) and drops bytes with a probability of loss_ppm / 1000000, or
+     * of what loss_model says for the current baudrate. With flow_control the
+     * sender holds back while the peer rx ring is full (RTS/CTS). A byte
+     * sent while the two ends run at different baudrates arrives garbled
+     * and counts as a framing error of the receiver (get_errors()). The
+     * clock is passed in, so a test can run the line in real or simulated
+     * time. Handler latency is the time from the arrival of the oldest
+     * unhandled byte to the handler call.
+     *
+     * Needs no hardware, the serial tests can run on a board without a wired
+     * pair and in the host build (src/test/host, host_uart_sim).
+     */
+    class SimulatedDevice
+    {
+      public:
+        struct config_t
+        {
+            uint32_t baudrate;
+            uint32_t loss_ppm;
+            uint32_t seed;
+            clock_source_t clock;
+            dispatch_t dispatch;
+            chunk_t rx_space;
+            chunk_t tx_space;
+            loss_model_t loss_model = nullptr;
+            bool flow_control = false;
+        };
+
+        explicit SimulatedDevice(const config_t &_config);
+
+        void connect(SimulatedDevice &_peer) { peer = &_peer; _peer.peer = this; }
+
+        void initialize();
+        void perform();
+        void shutdown();
+
+        void set_handler(ring_handler_t _handler) { handler = _handler; }
+
+        spscring_t *get_rx() { return &rx; }
+        spscring_t *get_tx() { return &tx; }
+
+        void set_baudrate(const uint32_t _baudrate);
+
+        uint32_t get_baudrate() const { return baudrate; }
+        uint32_t get_overflows() const { return statistics.overflows; }
+        uint32_t get_errors() const { return statistics.errors; }
+        uint32_t get_calls() const { return dispatcher.get_calls(); }
+        uint32_t get_saved() const { return dispatcher.get_saved(); }
+        const sim_statistics_t &get_statistics() const { return statistics; }
+
+      protected:
+        void transmit(const uint64_t _now);
+        void deliver(const uint8_t _value, const uint64_t _now);
+        bool lose();
+
+        const config_t config;
+        ring_handler_t handler = nullptr;
+        Dispatcher dispatcher;
+        SimulatedDevice *peer = nullptr;
+
+        spscring_t rx;
+        spscring_t tx;
+
+        uint32_t baudrate = 0;
+        uint32_t loss_ppm = 0;
+        uint64_t last_transmit = 0;
+        uint64_t credit = 0;
+        uint64_t oldest = 0;
+        size_t arrived = 0;
+        uint32_t random = 0;
+        bool active = false;
+        sim_statistics_t statistics;
+    };
+}
@@ -10,11 +10,19 @@
 
 #include "audio.hpp"
 #include "audio_defines.hpp"
+#include "audio_dma.hpp"
+#include "audio_melody.hpp"
+#include "audio_note_table.hpp"
 #include "audio_pwm.hpp"
+#include "audio_queue.hpp"
+#include "audio_render.hpp"
+#include "audio_synth.hpp"
+#include "audio_theme.hpp"
 #include "board_assembly.hpp"
 #include "chunk.h"
 #include "core.hpp"
 #include "soc_variant.hpp"
+#include "test_cycle_counter.hpp"
 #include "test_gpio.hpp"
 #include "test_record.hpp"
 #include "test_scheduler.hpp"
@@ -24,6 +32,8 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <pico/multicore.h>
 #include <pico/stdlib.h>
 
 namespace test::collection
@@ -445,5 +455,726 @@ namespace test::collection
 
                 TEST_ASSERT_MESSAGE(1, "done");
             });
+
+        namespace wavetable
+        {
+            using core::driver::audio::FULL_VOLUME;
+            using core::driver::audio::tone_t;
+
+            static const uint32_t RATE = 32000;
+            static const uint16_t TOP = 255;
+            static const size_t HALF = 256;
+
+            static const tone_t SEQUENCE[] = {
+                {1000, 100, FULL_VOLUME},
+                {0, 50, 0},
+                {2000, 100, FULL_VOLUME},
+                {1500, 33, 0x80},
+            };
+            static const size_t SAMPLES = (100 + 50 + 100 + 33) * RATE / 1000;
+
+            /* periods in [_from, _to): samples that reach the upper half after one in the lower half */
+            static uint32_t periods(const uint16_t *const _levels, const size_t _from, const size_t _to, const uint16_t _middle)
+            {
+                uint32_t result = 0;
+                for (size_t i = _from; i < _to; ++i)
+                {
+                    if (_levels[i] >= _middle && (i == _from || _levels[i - 1] < _middle))
+                    {
+                        result++;
+                    }
+                }
+                return result;
+            }
+
+            static uint16_t maximum(const uint16_t *const _levels, const size_t _from, const size_t _to)
+            {
+                uint16_t result = 0;
+                for (size_t i = _from; i < _to; ++i)
+                {
+                    result = _levels[i] > result ? _levels[i] : result;
+                }
+                return result;
+            }
+
+            /* renders the whole sequence in blocks of _block samples, the way the buffer refills would */
+            static size_t render(core::driver::audio::Synthesizer &_synthesizer, uint16_t *const _levels, const size_t _size, const size_t _block)
+            {
+                _synthesizer.play(SEQUENCE, sizeof(SEQUENCE) / sizeof(SEQUENCE[0]));
+                size_t rendered = 0;
+                for (size_t i = 0; i < _size; i += _block)
+                {
+                    rendered += _synthesizer.render(&_levels[i], _block < _size - i ? _block : _size - i);
+                }
+                return rendered;
+            }
+        }
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::WAVETABLE> test_audio_wavetable(
+            []()
+            {
+                static uint16_t levels[wavetable::SAMPLES + wavetable::HALF];
+                static uint16_t again[wavetable::SAMPLES + wavetable::HALF];
+                const size_t size = sizeof(levels) / sizeof(levels[0]);
+
+                core::driver::audio::Synthesizer square({wavetable::RATE, wavetable::TOP, &core::driver::audio::wave::SQUARE});
+                const size_t rendered = wavetable::render(square, levels, size, wavetable::HALF);
+
+                const size_t pause = 100 * wavetable::RATE / 1000;
+                const size_t high = 150 * wavetable::RATE / 1000;
+                const size_t quiet = 250 * wavetable::RATE / 1000;
+                const uint16_t middle = wavetable::TOP / 2;
+
+                printf("audio wavetable: %u samples, %lu/%lu/%lu periods, levels %u/%u\n",
+                       static_cast<unsigned>(rendered),
+                       wavetable::periods(levels, 0, pause, middle),
+                       wavetable::periods(levels, high, quiet, middle),
+                       wavetable::periods(levels, quiet, wavetable::SAMPLES, middle / 2),
+                       wavetable::maximum(levels, 0, pause),
+                       wavetable::maximum(levels, quiet, wavetable::SAMPLES));
+
+                TEST_ASSERT_MESSAGE(rendered == wavetable::SAMPLES && !square.is_playing(), "sequence length differs");
+                TEST_ASSERT_MESSAGE(wavetable::periods(levels, 0, pause, middle) == 100, "1000 Hz tone");
+                TEST_ASSERT_MESSAGE(wavetable::maximum(levels, pause, high) == 0, "pause not silent");
+                TEST_ASSERT_MESSAGE(wavetable::periods(levels, high, quiet, middle) == 200, "2000 Hz tone");
+                TEST_ASSERT_MESSAGE(wavetable::periods(levels, quiet, wavetable::SAMPLES, middle / 2) == 50, "1500 Hz tone");
+                TEST_ASSERT_MESSAGE(wavetable::maximum(levels, 0, pause) >= wavetable::TOP - 1, "full volume level");
+                TEST_ASSERT_MESSAGE(wavetable::maximum(levels, quiet, wavetable::SAMPLES) <= wavetable::TOP / 2, "half volume level");
+                TEST_ASSERT_MESSAGE(wavetable::maximum(levels, wavetable::SAMPLES, size) == 0, "not silent after the sequence");
+
+                /* the samples do not depend on how the buffer is refilled */
+                for (const size_t block : {size_t{1}, size_t{7}, size_t{1000}})
+                {
+                    memset(again, 0xaa, sizeof(again));
+                    wavetable::render(square, again, size, block);
+                    TEST_ASSERT_MESSAGE(memcmp(levels, again, sizeof(levels)) == 0, "block size changes the samples");
+                }
+
+                /* skipped halves across note boundaries, what follows is the same as after rendering them */
+                square.play(wavetable::SEQUENCE, sizeof(wavetable::SEQUENCE) / sizeof(wavetable::SEQUENCE[0]));
+                const uint64_t skipped = square.skip(13 * wavetable::HALF + 5);
+                square.render(again, wavetable::HALF);
+                TEST_ASSERT_MESSAGE(skipped == 13 * wavetable::HALF + 5 && memcmp(again, &levels[skipped], wavetable::HALF * sizeof(uint16_t)) == 0,
+                                    "skip differs from rendering");
+
+                /* interleaved into the 32 bit compare register, the other channel stays untouched */
+                uint16_t compare[2 * wavetable::HALF];
+                memset(compare, 0xaa, sizeof(compare));
+                square.play(wavetable::SEQUENCE, 1);
+                square.render(&compare[1], wavetable::HALF, 2);
+                for (size_t i = 0; i < wavetable::HALF; ++i)
+                {
+                    TEST_ASSERT_MESSAGE(compare[2 * i] == 0xaaaa && compare[2 * i + 1] == levels[i], "stride");
+                }
+
+                core::driver::audio::Synthesizer sine({wavetable::RATE, wavetable::TOP, &core::driver::audio::wave::SINE});
+                wavetable::render(sine, again, size, wavetable::HALF);
+                TEST_ASSERT_MESSAGE(wavetable::periods(again, 0, pause, middle) == 100 && wavetable::maximum(again, 0, pause) >= wavetable::TOP - 2,
+                                    "sine tone");
+            });
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::DMA> test_audio_dma(
+            []()
+            {
+#if PICO_ON_DEVICE
+                details::test_init_gpio();
+
+                /* 12/13 mark the test, the sound comes out on 14 */
+                static core::driver::audio::DmaAudio audio({14, wavetable::RATE, wavetable::TOP, &core::driver::audio::wave::SQUARE});
+                audio.initialize();
+
+                gpio_put(12, 1);
+                const uint64_t start = time_us_64();
+                audio.play(wavetable::SEQUENCE, sizeof(wavetable::SEQUENCE) / sizeof(wavetable::SEQUENCE[0]));
+
+                /* a busy main loop, up to 5 ms between two perform() calls */
+                uint32_t random = 1;
+                uint32_t loops = 0;
+                while (audio.is_active() && time_us_64() - start < 1000000)
+                {
+                    audio.perform();
+                    random = random * 1664525u + 1013904223u;
+                    busy_wait_us_32((random >> 8) % 5000);
+                    loops++;
+                }
+                const uint64_t duration = time_us_64() - start;
+                gpio_put(12, 0);
+
+                const uint32_t underruns = audio.get_underruns();
+
+                printf("audio dma: %lu us for %lu us of samples, %lu refills %lu underruns, %lu main loop turns\n",
+                       static_cast<uint32_t>(duration),
+                       static_cast<uint32_t>(wavetable::SAMPLES * 1000000ull / wavetable::RATE),
+                       audio.get_refills(),
+                       underruns,
+                       loops);
+
+                /* a main loop that stalls for five halves: the DMA replays four or five of them, the sequence keeps its timing */
+                audio.play(wavetable::SEQUENCE, sizeof(wavetable::SEQUENCE) / sizeof(wavetable::SEQUENCE[0]));
+                const uint64_t restart = time_us_64();
+                busy_wait_us_32(5 * core::driver::audio::DmaAudio::HALF * 1000000 / wavetable::RATE);
+                while (audio.is_active() && time_us_64() - restart < 1000000)
+                {
+                    audio.perform();
+                }
+                const uint64_t stalled = time_us_64() - restart;
+
+                printf("audio dma: main loop stalled for 5 halves, %lu underruns, %lu us\n", audio.get_underruns(), static_cast<uint32_t>(stalled));
+
+                audio.shutdown();
+
+                TEST_ASSERT_MESSAGE(underruns == 0, "buffer underrun");
+                /* the sequence plus up to two silent halves and one loop turn */
+                TEST_ASSERT_MESSAGE(duration >= wavetable::SAMPLES * 1000000ull / wavetable::RATE &&
+                                        duration < (wavetable::SAMPLES + 2 * core::driver::audio::DmaAudio::HALF) * 1000000ull / wavetable::RATE + 5000,
+                                    "sequence timing");
+                TEST_ASSERT_MESSAGE(audio.get_underruns() >= 4 && audio.get_underruns() <= 5, "missed halves not counted");
+                TEST_ASSERT_MESSAGE(stalled < (wavetable::SAMPLES + 2 * core::driver::audio::DmaAudio::HALF) * 1000000ull / wavetable::RATE + 5000,
+                                    "stalled sequence falls behind");
+#else
+                TEST_ASSERT_MESSAGE(true, "DMA audio needs the device");
+#endif
+            });
+
+        namespace note_table
+        {
+            using core::driver::audio::NoteTable;
+            namespace note = core::driver::audio::note;
+
+            static_assert(note::millihertz(note::A4) == 440000 && note::millihertz(note::A4 + 12) == 880000, "note frequencies");
+            static_assert(NoteTable<133000000>::max_error_ppm() <= 5000, "133 MHz clock");
+            static_assert(NoteTable<48000000>::max_error_ppm() <= 5000, "48 MHz clock");
+            static_assert(core::driver::audio::pwm_setting::level_for(NoteTable<>::of(note::A4), 0xff) == NoteTable<>::of(note::A4).level, "full volume");
+            static_assert(core::driver::audio::pwm_setting::level_for(NoteTable<>::of(note::LOWEST), 0) == 0 &&
+                              core::driver::audio::pwm_setting::level_for(NoteTable<>::of(note::HIGHEST), 0) == 0,
+                          "volume 0 is silent");
+        }
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::NOTE_TABLE> test_audio_note_table(
+            []()
+            {
+                using core::driver::audio::pwm_setting_t;
+                using core::driver::audio::NoteTable;
+                namespace note = core::driver::audio::note;
+                namespace pwm_setting = core::driver::audio::pwm_setting;
+
+                /*
+                    no player in this tree computes pwm settings at runtime, the
+                    table is timed against pwm_setting::compute(), the function
+                    that builds it, called per note with frequencies the
+                    compiler does not know
+                */
+                static volatile uint32_t millihertz[note::COUNT];
+                static volatile uint8_t notes[note::COUNT];
+                for (size_t i = 0; i < note::COUNT; ++i)
+                {
+                    notes[i] = static_cast<uint8_t>(note::LOWEST + i);
+                    millihertz[i] = note::millihertz(notes[i]);
+                }
+
+                static pwm_setting_t computed[note::COUNT];
+                static pwm_setting_t looked_up[note::COUNT];
+
+                details::CycleCounter counter;
+                uint32_t compute_cycles = UINT32_MAX;
+                uint32_t table_cycles = UINT32_MAX;
+                for (int run = 0; run < 5; ++run)
+                {
+                    counter.start();
+                    for (size_t i = 0; i < note::COUNT; ++i)
+                    {
+                        computed[i] = pwm_setting::compute(core::driver::audio::DEFAULT_CLOCK, millihertz[i]);
+                    }
+                    const uint32_t compute = counter.stop();
+
+                    counter.start();
+                    for (size_t i = 0; i < note::COUNT; ++i)
+                    {
+                        looked_up[i] = NoteTable<>::of(notes[i]);
+                    }
+                    const uint32_t table = counter.stop();
+
+                    compute_cycles = compute < compute_cycles ? compute : compute_cycles;
+                    table_cycles = table < table_cycles ? table : table_cycles;
+                }
+
+                uint32_t worst = 0;
+                for (size_t i = 0; i < note::COUNT; ++i)
+                {
+                    TEST_ASSERT_MESSAGE(computed[i].div_int == looked_up[i].div_int && computed[i].div_frac == looked_up[i].div_frac &&
+                                            computed[i].wrap == looked_up[i].wrap && computed[i].level == looked_up[i].level,
+                                        "table differs from the computed setting");
+                    const uint32_t error = NoteTable<>::error_ppm(notes[i]);
+                    worst = error > worst ? error : worst;
+                }
+
+                printf("audio note table: %u notes, %lu bytes, worst error %lu ppm, %lu cycles per note with pwm_setting::compute() (no player uses it), %lu from the table\n",
+                       static_cast<unsigned>(note::COUNT),
+                       static_cast<uint32_t>(note::COUNT * sizeof(pwm_setting_t)),
+                       worst,
+                       compute_cycles / static_cast<uint32_t>(note::COUNT),
+                       table_cycles / static_cast<uint32_t>(note::COUNT));
+
+                TEST_ASSERT_MESSAGE(worst <= NoteTable<>::MAX_ERROR_PPM, "note frequency off by more than 0.5%");
+                /* the M0+ has no divider for 64 bit, the gap is much larger there than on a host */
+                TEST_ASSERT_MESSAGE(table_cycles < compute_cycles, "table not faster than computing the setting");
+
+#if PICO_ON_DEVICE
+                /* the fast setter on the pwm of the test pin */
+                gpio_set_function(14, GPIO_FUNC_PWM);
+                const uint slice = pwm_gpio_to_slice_num(14);
+                const uint channel = pwm_gpio_to_channel(14);
+                pwm_set_enabled(slice, true);
+                for (uint8_t n = note::A4; n <= note::A4 + 12; ++n)
+                {
+                    core::driver::audio::apply(slice, channel, NoteTable<>::of(n), 0x80);
+                    sleep_ms(50);
+                }
+                pwm_set_enabled(slice, false);
+#endif
+            });
+
+        namespace queue
+        {
+            using core::driver::audio::coalesce_t;
+            using core::driver::audio::FULL_VOLUME;
+            using core::driver::audio::priority_t;
+            using core::driver::audio::sound_t;
+            using core::driver::audio::tone_t;
+
+            /* producer contexts */
+            static const size_t MAIN = 0;
+            static const size_t INTERRUPT = 1;
+            static const size_t CORE1 = 2;
+
+            static const tone_t SERVICE[] = {{523, 100, FULL_VOLUME}, {659, 100, FULL_VOLUME}, {784, 100, FULL_VOLUME}};
+            static const tone_t DONE[] = {{784, 100, FULL_VOLUME}, {1047, 200, FULL_VOLUME}};
+            static const tone_t WORK[] = {{440, 100, FULL_VOLUME}, {0, 50, 0}};
+            static const tone_t RELAX[] = {{392, 200, 0x40}, {330, 200, 0x40}, {262, 200, 0x40}, {0, 200, 0}};
+            static const tone_t ALERT[] = {{1760, 50, FULL_VOLUME}, {0, 50, 0}};
+
+            /* a sound lasts one tick per tone, the player records what it started */
+            struct Player
+            {
+                static const size_t HISTORY = 16;
+
+                void play(const tone_t *const _tones, const size_t _count)
+                {
+                    history[starts++ % HISTORY] = _tones;
+                    last_count = _count;
+                    left = endless ? _count : 0;
+                }
+                void stop()
+                {
+                    left = 0;
+                    stops++;
+                }
+                bool is_active() const { return left > 0; }
+                void tick() { left -= left ? 1 : 0; }
+
+                bool endless = true;
+                const tone_t *history[HISTORY] = {};
+                size_t starts = 0;
+                size_t stops = 0;
+                size_t left = 0;
+                size_t last_count = 0;
+            };
+
+            typedef core::driver::audio::SoundQueue<Player> Queue;
+
+            template <size_t SIZE>
+            static sound_t sound(const tone_t (&_tones)[SIZE], const priority_t _priority, const coalesce_t _coalesce = coalesce_t::APPEND)
+            {
+                return sound_t{_tones, static_cast<uint16_t>(SIZE), _priority, _coalesce};
+            }
+
+            static void run(Queue &_queue, Player &_player)
+            {
+                for (size_t tick = 0; tick < 1000 && !_queue.is_idle(); ++tick)
+                {
+                    _player.tick();
+                    _queue.perform();
+                }
+            }
+
+            namespace stress
+            {
+                static const uint32_t SOUNDS = 4096;
+
+                static Player player;
+                static Queue queue(player);
+                static std::atomic<bool> finished{false};
+
+                /* request i plays the one tone at SEQUENCE[i], the tone address is its sequence number */
+                static tone_t SEQUENCE[SOUNDS];
+
+                static size_t sequence_of(const tone_t *const _tones)
+                {
+                    return static_cast<size_t>(_tones - SEQUENCE);
+                }
+
+                /* core1 never waits, a full ring is the drop the statistics report */
+                static void producer()
+                {
+                    for (uint32_t i = 0; i < SOUNDS; ++i)
+                    {
+                        queue.submit<CORE1>(sound_t{&SEQUENCE[i], 1, priority_t::NOTICE, coalesce_t::APPEND});
+                        for (volatile uint32_t delay = 0; delay < (i & 0x3f); ++delay)
+                        {
+                        }
+                    }
+                    finished.store(true);
+                }
+            }
+        }
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::QUEUE> test_audio_queue(
+            []()
+            {
+                using namespace queue;
+
+                /* test_audio_multi made explicit: back to back sounds play one after the other */
+                {
+                    Player player;
+                    Queue audio(player);
+                    audio.initialize();
+
+                    TEST_ASSERT_MESSAGE(audio.submit(MAIN, sound(SERVICE, priority_t::NOTICE)), "service rejected");
+                    TEST_ASSERT_MESSAGE(audio.submit(MAIN, sound(DONE, priority_t::NOTICE)), "done rejected");
+                    TEST_ASSERT_MESSAGE(audio.submit(MAIN, sound(WORK, priority_t::NOTICE)), "work rejected");
+                    TEST_ASSERT_MESSAGE(audio.submit(MAIN, sound(RELAX, priority_t::NOTICE)), "relax rejected");
+                    TEST_ASSERT_MESSAGE(audio.get_depth() == 4, "wrong depth before perform");
+
+                    run(audio, player);
+
+                    const core::driver::audio::queue_statistics_t statistics = audio.get_statistics();
+                    TEST_ASSERT_MESSAGE(player.starts == 4 && player.stops == 0, "sounds not played one after the other");
+                    TEST_ASSERT_MESSAGE(player.history[0] == SERVICE && player.history[1] == DONE && player.history[2] == WORK && player.history[3] == RELAX,
+                                        "wrong order");
+                    TEST_ASSERT_MESSAGE(statistics.played == 4 && statistics.dropped == 0 && statistics.max_depth == 4, "wrong statistics");
+                }
+
+                /* an alert from an interrupt preempts the ambient sound and jumps the line */
+                {
+                    Player player;
+                    Queue audio(player);
+                    audio.initialize();
+
+                    audio.submit(MAIN, sound(RELAX, priority_t::AMBIENT));
+                    audio.submit(MAIN, sound(DONE, priority_t::NOTICE));
+                    audio.perform();
+                    TEST_ASSERT_MESSAGE(player.history[0] == DONE, "notice not before ambient");
+
+                    audio.submit(INTERRUPT, sound(ALERT, priority_t::ALERT));
+                    audio.perform();
+                    TEST_ASSERT_MESSAGE(player.starts == 2 && player.history[1] == ALERT && player.stops == 1, "alert did not preempt");
+
+                    /* an alert does not preempt another alert */
+                    audio.submit(INTERRUPT, sound(SERVICE, priority_t::ALERT));
+                    audio.perform();
+                    TEST_ASSERT_MESSAGE(player.starts == 2, "alert preempted by an alert");
+
+                    run(audio, player);
+                    TEST_ASSERT_MESSAGE(player.starts == 4 && player.history[2] == SERVICE && player.history[3] == RELAX, "wrong order after the alert");
+                    TEST_ASSERT_MESSAGE(audio.get_statistics().preempted == 1 && audio.get_statistics().played == 3, "wrong preemption count");
+                }
+
+                /* duplicates */
+                {
+                    Player player;
+                    Queue audio(player);
+                    audio.initialize();
+
+                    audio.submit(MAIN, sound(WORK, priority_t::NOTICE));
+                    audio.perform();
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        audio.submit(MAIN, sound(WORK, priority_t::NOTICE, coalesce_t::DROP));
+                    }
+                    audio.submit(MAIN, sound(DONE, priority_t::NOTICE));
+                    audio.submit(MAIN, sound(DONE, priority_t::NOTICE, coalesce_t::REPLACE));
+                    audio.submit(MAIN, sound(SERVICE, priority_t::NOTICE));
+                    audio.submit(MAIN, sound(DONE, priority_t::NOTICE, coalesce_t::REPLACE));
+                    run(audio, player);
+
+                    TEST_ASSERT_MESSAGE(player.starts == 3 && player.history[1] == SERVICE && player.history[2] == DONE, "wrong coalescing");
+                    TEST_ASSERT_MESSAGE(audio.get_statistics().coalesced == 6, "wrong coalesced count");
+
+                    /* a playing sound restarts */
+                    audio.submit(MAIN, sound(RELAX, priority_t::AMBIENT));
+                    audio.perform();
+                    player.tick();
+                    player.tick();
+                    audio.submit(MAIN, sound(RELAX, priority_t::AMBIENT, coalesce_t::REPLACE));
+                    audio.perform();
+                    TEST_ASSERT_MESSAGE(player.starts == 5 && player.left == 4, "playing sound not restarted");
+                }
+
+                /* full ring and full waiting list, submit returns at once */
+                {
+                    Player player;
+                    Queue audio(player);
+                    audio.initialize();
+
+                    size_t accepted = 0;
+                    for (int i = 0; i < 10; ++i)
+                    {
+                        accepted += audio.submit(INTERRUPT, sound(WORK, priority_t::AMBIENT)) ? 1 : 0;
+                    }
+                    TEST_ASSERT_MESSAGE(accepted == 8 && audio.get_depth() == 8 && audio.get_statistics().dropped == 2, "ring overflow");
+                    TEST_ASSERT_MESSAGE(!audio.submit(3, sound(WORK, priority_t::AMBIENT)) && audio.get_depth() == 8, "unknown source accepted");
+
+                    audio.perform();
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        audio.submit(MAIN, sound(SERVICE, priority_t::AMBIENT));
+                    }
+                    audio.submit(MAIN, sound(DONE, priority_t::NOTICE));
+                    audio.perform();
+                    TEST_ASSERT_MESSAGE(player.history[1] == DONE, "notice lost in a full list");
+                    TEST_ASSERT_MESSAGE(audio.get_statistics().dropped == 5 && audio.get_depth() == 7, "waiting list overflow");
+                }
+
+                /* core1 submits while the main loop plays, nothing is lost without being counted */
+                {
+                    for (tone_t &tone : stress::SEQUENCE)
+                    {
+                        tone = WORK[0];
+                    }
+                    stress::player.endless = false;
+                    stress::queue.initialize();
+                    stress::finished.store(false);
+
+                    details::CycleCounter counter;
+                    uint32_t slowest = 0;
+                    size_t disorder = 0;
+                    size_t last = 0;
+
+                    multicore_launch_core1(stress::producer);
+                    while (!stress::finished.load() || !stress::queue.is_idle())
+                    {
+                        const size_t starts = stress::player.starts;
+                        counter.start();
+                        stress::queue.perform();
+                        const uint32_t cycles = counter.stop();
+                        slowest = cycles > slowest ? cycles : slowest;
+
+                        if (stress::player.starts != starts)
+                        {
+                            const size_t sequence = stress::sequence_of(stress::player.history[(stress::player.starts - 1) % Player::HISTORY]);
+                            disorder += (starts && sequence <= last) ? 1 : 0;
+                            disorder += stress::player.last_count != 1 ? 1 : 0;
+                            last = sequence;
+                        }
+                    }
+                    multicore_reset_core1();
+
+                    const core::driver::audio::queue_statistics_t statistics = stress::queue.get_statistics();
+                    printf("audio queue: %lu submitted, %lu played, %lu dropped, max depth %lu, slowest perform %lu cycles\n",
+                           stress::SOUNDS,
+                           statistics.played,
+                           statistics.dropped,
+                           statistics.max_depth,
+                           slowest);
+
+                    TEST_ASSERT_MESSAGE(statistics.played + statistics.dropped == stress::SOUNDS, "sounds vanished");
+                    TEST_ASSERT_MESSAGE(statistics.played == stress::player.starts, "played count");
+                    TEST_ASSERT_MESSAGE(disorder == 0, "sounds reordered or duplicated");
+                }
+            });
+
+        namespace melody
+        {
+            using core::driver::audio::FULL_VOLUME;
+            using core::driver::audio::tone_t;
+            namespace melody = core::driver::audio::melody;
+
+            constexpr char SHORT[] = "short:d=8,o=5,b=120: c, 4e., p ,16g#6,2c7";
+            constexpr auto PACKED = melody::pack<melody::count(SHORT)>(SHORT, 0x80);
+            constexpr auto TONES = melody::unpack(PACKED);
+
+            static_assert(PACKED.valid && PACKED.size() == 5 && sizeof(PACKED.bits) == 7, "short melody");
+            static_assert(TONES[0].frequency == 523 && TONES[0].duration_ms == 250 && TONES[0].volume == 0x80, "c5 eighth");
+            static_assert(TONES[1].frequency == 659 && TONES[1].duration_ms == 750, "e5 dotted quarter");
+            static_assert(TONES[2].frequency == 0 && TONES[2].duration_ms == 250 && TONES[2].volume == 0, "pause");
+            static_assert(TONES[3].frequency == 1661 && TONES[3].duration_ms == 125, "g#6 sixteenth");
+            static_assert(TONES[4].frequency == 2093 && TONES[4].duration_ms == 1000, "c7 half");
+
+            static_assert(!melody::pack<1>("x:d=4,o=5,b=120:q").valid, "unknown letter");
+            static_assert(!melody::pack<1>("x:d=3,o=5,b=120:c").valid, "odd default duration");
+            static_assert(!melody::pack<1>("x:d=4,o=5,b=120:64c").valid, "too short");
+            static_assert(!melody::pack<1>("x:d=4,o=1,b=120:c").valid, "below the note table");
+            static_assert(!melody::pack<2>("x:d=4,o=5,b=120:c").valid, "wrong note count");
+            static_assert(!melody::pack<1>("x:d=4,o=5,b=120").valid, "no notes");
+            static_assert(!melody::pack<1>("x:d=1,o=5,b=4:c.").valid, "dotted whole beyond 65535 ms");
+            static_assert(melody::pack<1>("x:d=1,o=5,b=4:c").valid && melody::pack<1>("x:d=1,o=5,b=4:c").view().at(0).duration_ms == 60000,
+                          "whole at 4 bpm");
+            static_assert(melody::pack<1>("x:d=1,o=5,b=6:c.").view().at(0).duration_ms == 60000, "dotted whole at 6 bpm");
+
+            /* what a theme costs in flash as a tone table and packed */
+            template <size_t NOTES>
+            static void report(const char *const _name, const core::driver::audio::Melody<NOTES> &_theme)
+            {
+                printf("audio melody %s: %u notes, %u bytes as tone_t, %u bytes packed\n",
+                       _name,
+                       static_cast<unsigned>(NOTES),
+                       static_cast<unsigned>(sizeof(tone_t) * NOTES),
+                       static_cast<unsigned>(sizeof(_theme)));
+            }
+
+            /* the packed melody renders the same samples as its tone table */
+            template <size_t NOTES>
+            static bool same(const core::driver::audio::Melody<NOTES> &_theme)
+            {
+                static uint16_t packed[256];
+                static uint16_t plain[256];
+                const std::array<tone_t, NOTES> tones = melody::unpack(_theme);
+
+                core::driver::audio::Synthesizer first({8000, 255, &core::driver::audio::wave::SQUARE});
+                core::driver::audio::Synthesizer second({8000, 255, &core::driver::audio::wave::SQUARE});
+                first.play(_theme.view());
+                second.play(tones.data(), tones.size());
+
+                while (first.is_playing() || second.is_playing())
+                {
+                    if (first.render(packed, 256) != second.render(plain, 256) || memcmp(packed, plain, sizeof(packed)))
+                    {
+                        return false;
+                    }
+                }
+                return first.get_position() == second.get_position();
+            }
+        }
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::MELODY> test_audio_melody(
+            []()
+            {
+                namespace theme = core::driver::audio::theme;
+                using core::driver::audio::tone_t;
+
+                melody::report("imperial march", theme::IMPERIAL_MARCH);
+                melody::report("ode to joy", theme::ODE_TO_JOY);
+                melody::report("fanfare", theme::FANFARE);
+
+                TEST_ASSERT_MESSAGE(sizeof(theme::IMPERIAL_MARCH) * 4 < sizeof(tone_t) * theme::IMPERIAL_MARCH.size(), "packed theme not a quarter of the table");
+
+                TEST_ASSERT_MESSAGE(melody::same(theme::IMPERIAL_MARCH), "imperial march differs from its tone table");
+                TEST_ASSERT_MESSAGE(melody::same(theme::ODE_TO_JOY), "ode to joy differs from its tone table");
+                TEST_ASSERT_MESSAGE(melody::same(theme::FANFARE), "fanfare differs from its tone table");
+
+                /* decoding happens once per note start */
+                const core::driver::audio::melody_view_t view = theme::IMPERIAL_MARCH.view();
+                details::CycleCounter counter;
+                uint32_t duration = 0;
+                counter.start();
+                for (size_t i = 0; i < view.count; ++i)
+                {
+                    duration += view.at(i).duration_ms;
+                }
+                const uint32_t cycles = counter.stop();
+
+                printf("audio melody: imperial march %lu ms, %lu cycles per decoded note\n", duration, cycles / view.count);
+                TEST_ASSERT_MESSAGE(duration == 18600, "imperial march duration");
+            });
+
+        namespace render
+        {
+            using core::driver::audio::Recorder;
+            using core::driver::audio::tone_t;
+            namespace jitter = core::driver::audio::jitter;
+
+            static const uint32_t RATE = 8000;
+
+            /* the target renders the same bits as the host, see src/test/host/golden/audio_render.txt */
+            struct golden_t
+            {
+                const char *name;
+                uint32_t samples;
+                uint16_t crc;
+                uint16_t notes;
+            };
+
+            static const golden_t FANFARE = {"fanfare", 25688, 0x75f8, 13};
+            static const golden_t ODE_TO_JOY = {"ode_to_joy", 128000, 0x46ea, 30};
+            static const golden_t IMPERIAL_MARCH = {"imperial_march", 148800, 0xd0d0, 55};
+
+            template <size_t NOTES>
+            static bool check(Recorder &_recorder, const golden_t &_golden, const core::driver::audio::Melody<NOTES> &_melody)
+            {
+                _recorder.record(_melody.view());
+                printf("audio render %s: %lu samples, crc 0x%04x, %u notes\n",
+                       _golden.name,
+                       static_cast<uint32_t>(_recorder.get_samples()),
+                       _recorder.get_crc(),
+                       static_cast<unsigned>(_recorder.get_notes()));
+
+                return _recorder.get_samples() == _golden.samples && _recorder.get_crc() == _golden.crc && _recorder.get_notes() == _golden.notes;
+            }
+        }
+
+        record::Item<test::GROUP::AUDIO, test::audio::IDENTIFIER::RENDER> test_audio_render(
+            []()
+            {
+                namespace theme = core::driver::audio::theme;
+                using render::jitter::cadence_t;
+                using render::jitter::drift_t;
+                using core::driver::audio::tone_t;
+
+                render::Recorder recorder({render::RATE, 255, &core::driver::audio::wave::SINE});
+
+                TEST_ASSERT_MESSAGE(render::check(recorder, render::FANFARE, theme::FANFARE), "fanfare differs from the golden rendering");
+                TEST_ASSERT_MESSAGE(render::check(recorder, render::ODE_TO_JOY, theme::ODE_TO_JOY), "ode to joy differs from the golden rendering");
+                TEST_ASSERT_MESSAGE(render::check(recorder, render::IMPERIAL_MARCH, theme::IMPERIAL_MARCH), "imperial march differs from the golden rendering");
+
+                /* the log of the last sequence: onsets at the summed up durations */
+                uint32_t elapsed_ms = 0;
+                for (size_t i = 0; i < recorder.get_notes(); ++i)
+                {
+                    const core::driver::audio::onset_t &onset = recorder.get_onset(i);
+                    TEST_ASSERT_MESSAGE(onset.sample == elapsed_ms * render::RATE / 1000, "note onset off");
+                    elapsed_ms += onset.duration_ms;
+                }
+
+                uint8_t header[core::driver::audio::wav::HEADER];
+                core::driver::audio::wav::header(header, render::RATE, 100);
+                TEST_ASSERT_MESSAGE(memcmp(header, "RIFF", 4) == 0 && header[4] == 236 && memcmp(&header[8], "WAVEfmt ", 8) == 0 && header[40] == 200,
+                                    "wav header");
+
+                /* perform() cadence against note onsets, DmaAudio halves of 256 samples at 32 kHz last 8 ms */
+                const tone_t *const tones = queue::RELAX;
+                const size_t count = sizeof(queue::RELAX) / sizeof(tone_t);
+                const cadence_t cadences[] = {{1000, 0, 1}, {1000, 900, 2}, {5000, 2500, 3}, {6000, 5000, 4}};
+
+                drift_t loop[4];
+                drift_t sample[4];
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    loop[i] = render::jitter::loop_driven(tones, count, cadences[i]);
+                    sample[i] = render::jitter::sample_based(tones, count, wavetable::RATE, wavetable::HALF, cadences[i]);
+                    printf("audio render jitter %lu+-%lu us: loop driven %lu/%lu us, sample based %lu/%lu us, %lu underruns (max/mean drift)\n",
+                           cadences[i].period_us,
+                           cadences[i].jitter_us,
+                           loop[i].max_us,
+                           loop[i].mean_us,
+                           sample[i].max_us,
+                           sample[i].mean_us,
+                           sample[i].underruns);
+                    TEST_ASSERT_MESSAGE(loop[i].notes == sample[i].notes, "onsets missing");
+                }
+
+                TEST_ASSERT_MESSAGE(sample[0].max_us == 0 && sample[1].max_us == 0 && sample[2].max_us == 0, "sample based onsets drift");
+                TEST_ASSERT_MESSAGE(sample[2].underruns == 0, "underrun below the half duration");
+                TEST_ASSERT_MESSAGE(loop[1].max_us > loop[0].max_us && loop[2].max_us > loop[1].max_us, "loop driven drift does not grow with the cadence");
+                TEST_ASSERT_MESSAGE(sample[3].underruns > 0 && sample[3].max_us <= 8000, "sample based drift adds up over underruns");
+                TEST_ASSERT_MESSAGE(loop[3].max_us > sample[3].max_us, "loop driven onsets drift less than sample based ones");
+
+                /* perform() every 40 ms or five halves: all slots but the first two and the one refilled per call replay stale content */
+                const uint32_t halves = 800 * wavetable::RATE / 1000 / wavetable::HALF;
+                const drift_t laps = render::jitter::sample_based(tones, count, wavetable::RATE, wavetable::HALF, {40000, 0, 5});
+                printf("audio render jitter 40000 us: sample based %lu/%lu us, %lu underruns\n", laps.max_us, laps.mean_us, laps.underruns);
+                TEST_ASSERT_MESSAGE(laps.notes == sample[0].notes, "onsets missing after several laps");
+                TEST_ASSERT_MESSAGE(laps.underruns == halves - 2 - (halves - 1) / 5, "missed halves not counted");
+                TEST_ASSERT_MESSAGE(laps.max_us < 40000, "sample based onsets fall behind over several laps");
+            });
     }
 }
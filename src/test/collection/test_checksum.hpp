@@ -9,7 +9,12 @@
 #pragma once
 
 #include "checksum.hpp"
+#include "checksum_backend.hpp"
+#include "checksum_engine.hpp"
+#include "checksum_stream.hpp"
+#include "checksum_words.hpp"
 #include "chunk.h"
+#include "test_cycle_counter.hpp"
 #include "test_record.hpp"
 #include "test_scheduler.hpp"
 #include "unit_identifier.hpp"
@@ -18,6 +23,7 @@
 #include <pico/stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 namespace test::collection
 {
@@ -35,8 +41,57 @@ namespace test::collection
         static const uint16_t RESULT_CRC_REFLECTED_POST = 0x94c5;
         static const uint32_t RESULT_HASH = 0xb384c08b;
 
+        static const size_t PATTERN_SIZE = 4096;
+        static uint8_t pattern[PATTERN_SIZE + 4];
+
+        static void fill_pattern()
+        {
+            uint32_t state = 0x12345678;
+            for (size_t i = 0; i < sizeof(pattern); ++i)
+            {
+                state = state * 1664525 + 1013904223;
+                pattern[i] = static_cast<uint8_t>(state >> 24);
+            }
+        }
+
         // void test_checksum()
         // {
+        static void check_backend(core::checksum::BackendInterface &_backend)
+        {
+            static const size_t SIZES[] = {0, 1, 63, 64, 65, 256, PATTERN_SIZE};
+
+            _backend.initialize();
+
+            TEST_ASSERT_MESSAGE(_backend.crc(&b, INITAL_VALUE) == RESULT_CRC, "wrong backend crc");
+            TEST_ASSERT_MESSAGE(_backend.crc_reflected(&b, INITAL_VALUE) == RESULT_CRC_REFLECTED, "wrong backend reflected crc");
+
+            fill_pattern();
+            for (const size_t size : SIZES)
+            {
+                for (size_t offset = 0; offset < 4; offset += 3)
+                {
+                    const chunk_t c = {&pattern[offset], size};
+                    const uint16_t initial = static_cast<uint16_t>(0x1d0f * (size + offset));
+
+                    TEST_ASSERT_MESSAGE(_backend.crc(&c, initial) == checksum_crc(&c, initial), "backend crc differs");
+                    TEST_ASSERT_MESSAGE(_backend.crc_reflected(&c, initial) == checksum_crc_reflected(&c, initial), "backend reflected crc differs");
+                }
+            }
+
+            /* background calculation */
+            const chunk_t c = {pattern, PATTERN_SIZE};
+            TEST_ASSERT_MESSAGE(_backend.start_crc(&c, INITAL_VALUE), "backend start failed");
+            uint32_t polls = 0;
+            while (_backend.is_busy())
+            {
+                polls++;
+            }
+            printf("checksum backend: %lu polls\n", polls);
+            TEST_ASSERT_MESSAGE(_backend.result() == checksum_crc(&c, INITAL_VALUE), "background crc differs");
+
+            _backend.shutdown();
+        }
+
         record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::PASSED> test_passed([]() { TEST_ASSERT_MESSAGE(true, "tbd"); });
 
         record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::PASSED> test_failed([]() { TEST_ASSERT_MESSAGE(true, "tbd"); });
@@ -115,6 +170,249 @@ namespace test::collection
                 printf("checksum hash: %08x\n", result_value);
                 TEST_ASSERT_MESSAGE(result_value == RESULT_HASH, "wrong hash value");
             });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::CRC_TABLE> test_crc_table(
+            []()
+            {
+                TEST_ASSERT_MESSAGE(checksum_crc_table(&b, INITAL_VALUE) == RESULT_CRC, "wrong table crc");
+                TEST_ASSERT_MESSAGE(checksum_crc_slice4(&b, INITAL_VALUE) == RESULT_CRC, "wrong slice4 crc");
+                TEST_ASSERT_MESSAGE(checksum_engine_crc(&b, INITAL_VALUE) == RESULT_CRC, "wrong engine crc");
+
+                TEST_ASSERT_MESSAGE(checksum_crc_reflected_table(&b, INITAL_VALUE) == RESULT_CRC_REFLECTED, "wrong table reflected crc");
+                TEST_ASSERT_MESSAGE(checksum_crc_reflected_slice4(&b, INITAL_VALUE) == RESULT_CRC_REFLECTED, "wrong slice4 reflected crc");
+                TEST_ASSERT_MESSAGE(checksum_engine_crc_reflected(&b, INITAL_VALUE) == RESULT_CRC_REFLECTED, "wrong engine reflected crc");
+
+                uint16_t result_value = INITAL_VALUE;
+                for (size_t i = 0; i < b.size; ++i)
+                {
+                    result_value = checksum_engine_crc_byte(a[i], result_value);
+                }
+                TEST_ASSERT_MESSAGE(result_value == RESULT_CRC, "wrong engine crc byte by byte");
+
+                /* unaligned starts, odd sizes and arbitrary initial values */
+                fill_pattern();
+                for (size_t offset = 0; offset < 4; ++offset)
+                {
+                    for (size_t size = 0; size < 67; ++size)
+                    {
+                        chunk_t c = {&pattern[offset], size};
+                        const uint16_t initial = static_cast<uint16_t>(size * 0x0101 + offset);
+
+                        const uint16_t crc = checksum_crc(&c, initial);
+                        TEST_ASSERT_MESSAGE(checksum_crc_table(&c, initial) == crc, "table crc differs");
+                        TEST_ASSERT_MESSAGE(checksum_crc_slice4(&c, initial) == crc, "slice4 crc differs");
+
+                        const uint16_t reflected = checksum_crc_reflected(&c, initial);
+                        TEST_ASSERT_MESSAGE(checksum_crc_reflected_table(&c, initial) == reflected, "table reflected crc differs");
+                        TEST_ASSERT_MESSAGE(checksum_crc_reflected_slice4(&c, initial) == reflected, "slice4 reflected crc differs");
+                    }
+                }
+                printf("checksum crc table: engine %d\n", CHECKSUM_CRC_ENGINE);
+            });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::CRC_BENCHMARK> test_crc_benchmark(
+            []()
+            {
+                static const size_t SIZES[] = {16, 256, PATTERN_SIZE};
+                static const uint32_t ROUNDS = 4;
+
+                fill_pattern();
+                details::CycleCounter counter;
+
+                for (const size_t size : SIZES)
+                {
+                    chunk_t c = {pattern, size};
+                    uint32_t cycles[3] = {0, 0, 0};
+                    volatile uint16_t sink = 0;
+
+                    for (uint32_t round = 0; round < ROUNDS; ++round)
+                    {
+                        counter.start();
+                        sink = checksum_crc(&c, INITAL_VALUE);
+                        cycles[0] += counter.stop();
+
+                        counter.start();
+                        sink = checksum_crc_table(&c, INITAL_VALUE);
+                        cycles[1] += counter.stop();
+
+                        counter.start();
+                        sink = checksum_crc_slice4(&c, INITAL_VALUE);
+                        cycles[2] += counter.stop();
+                    }
+                    (void)sink;
+
+                    const uint32_t bytes = static_cast<uint32_t>(size) * ROUNDS;
+                    printf("checksum crc %4u bytes: bitwise %lu.%02lu table %lu.%02lu slice4 %lu.%02lu cycles/byte\n",
+                           static_cast<unsigned>(size),
+                           cycles[0] / bytes,
+                           (cycles[0] % bytes) * 100 / bytes,
+                           cycles[1] / bytes,
+                           (cycles[1] % bytes) * 100 / bytes,
+                           cycles[2] / bytes,
+                           (cycles[2] % bytes) * 100 / bytes);
+
+                    TEST_ASSERT_MESSAGE(cycles[1] < cycles[0], "table crc is not faster than bitwise crc");
+                }
+            });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::STREAM> test_stream(
+            []()
+            {
+                /* every split point of the test vector */
+                for (size_t split = 0; split <= b.size; ++split)
+                {
+                    const chunk_t pieces[2] = {{a, split}, {&a[split], b.size - split}};
+
+                    checksum_context_t sum;
+                    checksum_init(&sum, CHECKSUM_STREAM_SUM, INITAL_VALUE);
+                    checksum_update_sequence(&sum, pieces, 2);
+                    TEST_ASSERT_MESSAGE(checksum_finalize(&sum) == RESULT_SUM, "wrong stream sum");
+
+                    checksum_context_t crc;
+                    checksum_init(&crc, CHECKSUM_STREAM_CRC, INITAL_VALUE);
+                    checksum_update_sequence(&crc, pieces, 2);
+                    TEST_ASSERT_MESSAGE(checksum_finalize(&crc) == RESULT_CRC, "wrong stream crc");
+
+                    checksum_context_t reflected;
+                    checksum_init(&reflected, CHECKSUM_STREAM_CRC_REFLECTED, INITAL_VALUE);
+                    checksum_update_sequence(&reflected, pieces, 2);
+                    TEST_ASSERT_MESSAGE(checksum_finalize(&reflected) == RESULT_CRC_REFLECTED, "wrong stream reflected crc");
+                    TEST_ASSERT_MESSAGE(reflected.length == b.size, "wrong stream length");
+                }
+
+                /* scattered pieces of a larger block, fed byte and chunk wise */
+                fill_pattern();
+                chunk_t whole = {pattern, PATTERN_SIZE};
+
+                checksum_context_t crc;
+                checksum_init(&crc, CHECKSUM_STREAM_CRC, 0xffff);
+                size_t position = 0;
+                size_t step = 1;
+                while (position < PATTERN_SIZE)
+                {
+                    const size_t size = (position + step > PATTERN_SIZE) ? PATTERN_SIZE - position : step;
+                    if (size == 1)
+                    {
+                        checksum_update_byte(&crc, pattern[position]);
+                    }
+                    else
+                    {
+                        const chunk_t piece = {&pattern[position], size};
+                        checksum_update(&crc, &piece);
+                    }
+                    position += size;
+                    step = (step * 3 + 1) % 97;
+                }
+
+                printf("checksum stream: %04x\n", checksum_finalize(&crc));
+                TEST_ASSERT_MESSAGE(checksum_finalize(&crc) == checksum_crc(&whole, 0xffff), "stream crc differs from one shot crc");
+            });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::HASH_WORDS> test_hash_words(
+            []()
+            {
+                using namespace core::checksum::words;
+
+                fill_pattern();
+
+                uint32_t state = 0xcafebeef;
+                for (int round = 0; round < 2000; ++round)
+                {
+                    state = state * 1664525 + 1013904223;
+                    const size_t offset = (state >> 8) & 0x3;
+                    const size_t size = (state >> 12) % (PATTERN_SIZE - 4);
+                    const chunk_t c = {&pattern[offset], size};
+
+                    TEST_ASSERT_MESSAGE(walk_words(&c, one_at_a_time::SEED, one_at_a_time()) == walk_bytes(&c, one_at_a_time::SEED, one_at_a_time()),
+                                        "one at a time word walk differs");
+                    TEST_ASSERT_MESSAGE(walk_words(&c, fnv1a::SEED, fnv1a()) == walk_bytes(&c, fnv1a::SEED, fnv1a()), "fnv1a word walk differs");
+                }
+
+                /* short chunks around every alignment */
+                for (size_t offset = 0; offset < 4; ++offset)
+                {
+                    for (size_t size = 0; size < 12; ++size)
+                    {
+                        const chunk_t c = {&pattern[offset], size};
+                        TEST_ASSERT_MESSAGE(walk_words(&c, fnv1a::SEED, fnv1a()) == walk_bytes(&c, fnv1a::SEED, fnv1a()), "short word walk differs");
+                    }
+                }
+
+                printf("checksum hash words: %08x\n", hash<fnv1a>(&b));
+            });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::HASH_BENCHMARK> test_hash_benchmark(
+            []()
+            {
+                using namespace core::checksum::words;
+
+                static const size_t SIZES[] = {16, 256, PATTERN_SIZE};
+
+                fill_pattern();
+                details::CycleCounter counter;
+
+                for (const size_t size : SIZES)
+                {
+                    volatile uint32_t sink = 0;
+                    uint32_t current = UINT32_MAX;
+                    uint32_t bytes = UINT32_MAX;
+                    uint32_t words = UINT32_MAX;
+                    uint32_t unaligned = UINT32_MAX;
+
+                    for (int run = 0; run < 5; ++run)
+                    {
+                        const chunk_t c = {&pattern[0], size};
+                        const chunk_t shifted = {&pattern[1], size};
+
+                        counter.start();
+                        sink = checksum_hash(&c);
+                        const uint32_t zero = counter.stop();
+
+                        counter.start();
+                        sink = walk_bytes(&c, one_at_a_time::SEED, one_at_a_time());
+                        const uint32_t byte_walk = counter.stop();
+
+                        counter.start();
+                        sink = walk_words(&c, one_at_a_time::SEED, one_at_a_time());
+                        const uint32_t word_walk = counter.stop();
+
+                        counter.start();
+                        sink = walk_words(&shifted, one_at_a_time::SEED, one_at_a_time());
+                        const uint32_t shifted_walk = counter.stop();
+
+                        current = zero < current ? zero : current;
+                        bytes = byte_walk < bytes ? byte_walk : bytes;
+                        words = word_walk < words ? word_walk : words;
+                        unaligned = shifted_walk < unaligned ? shifted_walk : unaligned;
+                    }
+                    (void)sink;
+
+                    /* checksum_hash is the zero library hash with its own step, a reference for the order of magnitude */
+                    printf("checksum hash %4u bytes: checksum_hash %lu, byte walk %lu, word walk %lu, unaligned word walk %lu cycles\n",
+                           static_cast<unsigned>(size),
+                           current,
+                           bytes,
+                           words,
+                           unaligned);
+
+                    /* the step is the same for both walks, only the loads differ */
+                    if (size >= 256)
+                    {
+                        TEST_ASSERT_MESSAGE(words <= bytes, "word walk slower than the byte walk");
+                        TEST_ASSERT_MESSAGE(unaligned <= bytes + bytes / 8, "unaligned word walk slower than the byte walk");
+                    }
+                }
+            });
+
+        record::Item<test::GROUP::CHECKSUM, test::checksum::IDENTIFIER::BACKEND> test_backend(
+            []()
+            {
+                core::checksum::SoftwareBackend software;
+                check_backend(software);
+
+                core::checksum::backend::Variant variant;
+                check_backend(variant);
+            });
         // }
     }
 }
@@ -0,0 +1,45 @@
+/**
+ * \file test_cycle_counter.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <hardware/structs/systick.h>
+#include <stdint.h>
+
+namespace test::collection
+{
+    namespace details
+    {
+        /**
+         * \brief Processor cycle counter based on the 24 bit SysTick.
+         *
+         * Good for measurements up to 2^24 cycles (~134ms at 125MHz).
+         */
+        class CycleCounter
+        {
+          public:
+            static const uint32_t MASK = 0x00ffffff;
+
+            CycleCounter()
+            {
+                systick_hw->rvr = MASK;
+                systick_hw->cvr = 0;
+                systick_hw->csr = 0x5; // enable, processor clock, no interrupt
+            }
+
+            ~CycleCounter() { systick_hw->csr = 0; }
+
+            void start() { begin = systick_hw->cvr; }
+
+            uint32_t stop() const { return (begin - systick_hw->cvr) & MASK; }
+
+          private:
+            uint32_t begin = 0;
+        };
+    }
+}
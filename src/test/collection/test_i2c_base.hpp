@@ -9,10 +9,17 @@
 #pragma once
 
 #include "core.hpp"
+#include "i2c_async.hpp"
+#include "i2c_burst.hpp"
+#include "i2c_bus.hpp"
+#include "i2c_register_map.hpp"
+#include "i2c_shadow_bank.hpp"
+#include "i2c_trace.hpp"
 #include "i2c_master.hpp"
 #include "i2c_master_variant.hpp"
 #include "i2c_slave.hpp"
 #include "i2c_slave_variant.hpp"
+#include "test_cycle_counter.hpp"
 #include "test_record.hpp"
 #include "test_scheduler.hpp"
 #include "unit_identifier.hpp"
@@ -38,6 +45,415 @@ namespace test::collection
                    core::driver::i2c::master::Variant::SCL_PIN);
         }
 
+        namespace async
+        {
+            static const uint8_t TARGET = 0x55;
+            static const uint8_t OTHER = 0x56;
+            static const uint8_t MISSING = 0x57;
+
+            static uint64_t now = 0;
+            static size_t order[16];
+            static size_t finished = 0;
+
+            static uint64_t clock()
+            {
+                return now;
+            }
+
+            /* the transaction array index tells the submission order */
+            static core::driver::i2c::transaction_t *base = nullptr;
+
+            static void record(core::driver::i2c::transaction_t *const _transaction)
+            {
+                order[finished++] = static_cast<size_t>(_transaction - base);
+            }
+        }
+
+        namespace map
+        {
+            namespace memory = core::driver::i2c::memory;
+
+            using Bank = memory::RegisterMap<memory::bla::register_t, memory::blub::register_t, memory::serial::register_t>;
+
+            /* a product with many registers, lookup time must not grow */
+            using Large = memory::RegisterMap<memory::describe<0x00, 4>,
+                                              memory::describe<0x04, 4>,
+                                              memory::describe<0x08, 8>,
+                                              memory::describe<0x10, 16>,
+                                              memory::describe<0x20, 2>,
+                                              memory::describe<0x22, 2>,
+                                              memory::describe<0x24, 12>,
+                                              memory::describe<0x30, 16>,
+                                              memory::describe<0x40, 32>,
+                                              memory::describe<0x60, 1>,
+                                              memory::describe<0x61, 1>,
+                                              memory::describe<0x62, 30>,
+                                              memory::describe<0x80, 64>,
+                                              memory::describe<0xc0, 16>,
+                                              memory::describe<0xd0, 16>,
+                                              memory::describe<0xe0, 16>>;
+
+            static_assert(!memory::layout::disjoint<memory::describe<0x10, 4>, memory::describe<0x12, 2>>(), "overlap not detected");
+            static_assert(!memory::layout::disjoint<memory::describe<0x10, 4>, memory::describe<0x0f, 2>>(), "overlap not detected");
+            static_assert(memory::layout::disjoint<memory::describe<0x10, 4>, memory::describe<0x14, 2>>(), "adjacent registers rejected");
+            static_assert(!memory::layout::in_range<memory::describe<0xfe, 4>>(), "register beyond 0xff not detected");
+            static_assert(!memory::layout::in_range<memory::describe<0x10, 0>>(), "empty register not detected");
+            static_assert(Bank::lookup(0xfe).index == memory::NO_REGISTER, "0xfe is mapped");
+
+            template <typename MAP>
+            static memory::slot_t search(const uint8_t _address)
+            {
+                for (size_t i = 0; i < MAP::COUNT; ++i)
+                {
+                    if (_address >= MAP::address_of(i) && _address < MAP::address_of(i) + MAP::size_of(i))
+                    {
+                        return memory::slot_t{static_cast<uint8_t>(i), static_cast<uint8_t>(_address - MAP::address_of(i))};
+                    }
+                }
+                return memory::slot_t{memory::NO_REGISTER, 0};
+            }
+
+            template <typename MAP>
+            static void check()
+            {
+                for (size_t address = 0; address < memory::ADDRESS_SPACE; ++address)
+                {
+                    const memory::slot_t slot = MAP::lookup(static_cast<uint8_t>(address));
+                    const memory::slot_t expected = search<MAP>(static_cast<uint8_t>(address));
+                    TEST_ASSERT_MESSAGE(slot.index == expected.index && slot.offset == expected.offset, "lookup differs from search");
+                }
+            }
+        }
+
+        namespace shadow
+        {
+            namespace memory = core::driver::i2c::memory;
+
+            static const uint32_t STEPS = 1000000;
+
+            /* single copy, what the bank does today without masking the isr */
+            struct NaiveBank
+            {
+                uint8_t space[map::Bank::total_size()] = {};
+                uint8_t pointer = 0;
+                bool expect_address = true;
+
+                uint8_t *edit(const size_t _index) { return &space[map::Bank::offset_of(_index)]; }
+                void publish(const size_t) {}
+
+                void receive(const uint8_t _value)
+                {
+                    if (expect_address)
+                    {
+                        expect_address = false;
+                        pointer = _value;
+                        return;
+                    }
+                    const memory::slot_t slot = map::Bank::lookup(pointer++);
+                    if (slot.index != memory::NO_REGISTER)
+                    {
+                        space[map::Bank::offset_of(slot.index) + slot.offset] = _value;
+                    }
+                }
+
+                uint8_t request()
+                {
+                    const memory::slot_t slot = map::Bank::lookup(pointer++);
+                    return slot.index == memory::NO_REGISTER ? 0xff : space[map::Bank::offset_of(slot.index) + slot.offset];
+                }
+
+                void restart() { expect_address = true; }
+                void stop() { expect_address = true; }
+
+                bool fetch(const size_t _index, uint8_t *const _target)
+                {
+                    memcpy(_target, &space[map::Bank::offset_of(_index)], map::Bank::size_of(_index));
+                    return true;
+                }
+            };
+
+            struct result_t
+            {
+                uint32_t reads;
+                uint32_t torn_reads;
+                uint32_t fetches;
+                uint32_t torn_fetches;
+            };
+
+            static bool uniform(const uint8_t *const _space, const size_t _size)
+            {
+                for (size_t i = 1; i < _size; ++i)
+                {
+                    if (_space[i] != _space[0])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /*
+                every step is either one byte of application work or one isr
+                event of the master, so the isr hits the application in the
+                middle of its multi byte updates; all bytes of a value are
+                equal, a mix shows a torn register
+            */
+            template <typename BANK>
+            static result_t interleave(BANK &_bank)
+            {
+                result_t result = {};
+                uint32_t random = 12345;
+                const auto next = [&random]()
+                {
+                    random = random * 1664525u + 1013904223u;
+                    return random >> 8;
+                };
+
+                size_t app_register = 0;
+                size_t app_offset = 0;
+                uint8_t *app_space = nullptr;
+                uint8_t app_value = 0;
+
+                size_t master_register = 0;
+                size_t master_offset = 0;
+                bool master_active = false;
+                bool master_read = false;
+                uint8_t master_value = 0;
+                uint8_t received[16];
+
+                for (uint32_t step = 0; step < STEPS; ++step)
+                {
+                    const uint32_t choice = next();
+                    if (choice & 1)
+                    {
+                        /* application */
+                        if (!app_space)
+                        {
+                            if ((choice >> 1) % 4 == 0)
+                            {
+                                uint8_t value[16];
+                                const size_t index = (choice >> 3) % map::Bank::COUNT;
+                                if (_bank.fetch(index, value))
+                                {
+                                    result.fetches++;
+                                    result.torn_fetches += uniform(value, map::Bank::size_of(index)) ? 0 : 1;
+                                }
+                                continue;
+                            }
+                            app_register = (choice >> 3) % map::Bank::COUNT;
+                            app_space = _bank.edit(app_register);
+                            app_offset = 0;
+                            app_value++;
+                        }
+
+                        app_space[app_offset++] = app_value;
+                        if (app_offset == map::Bank::size_of(app_register))
+                        {
+                            _bank.publish(app_register);
+                            app_space = nullptr;
+                        }
+                        continue;
+                    }
+
+                    /* master, one isr event per step */
+                    if (!master_active)
+                    {
+                        master_active = true;
+                        master_read = (choice >> 1) & 1;
+                        master_register = (choice >> 2) % map::Bank::COUNT;
+                        master_offset = 0;
+                        master_value++;
+                        _bank.receive(static_cast<uint8_t>(map::Bank::address_of(master_register)));
+                        continue;
+                    }
+
+                    if (master_offset < map::Bank::size_of(master_register))
+                    {
+                        if (master_read)
+                        {
+                            received[master_offset++] = _bank.request();
+                        }
+                        else
+                        {
+                            _bank.receive(master_value);
+                            master_offset++;
+                        }
+                        continue;
+                    }
+
+                    _bank.stop();
+                    master_active = false;
+                    if (master_read)
+                    {
+                        result.reads++;
+                        result.torn_reads += uniform(received, master_offset) ? 0 : 1;
+                    }
+                }
+
+                return result;
+            }
+        }
+
+        namespace dirty
+        {
+            using Bank = core::driver::i2c::memory::ShadowBank<map::Large>;
+
+            static uint32_t calls = 0;
+            static Bank::changes_t last = {};
+
+            static void handler(const Bank::changes_t &_changes)
+            {
+                calls++;
+                last = _changes;
+            }
+
+            /* one master write transaction, register pointer first */
+            static void write(Bank &_bank, const uint8_t _address, const uint8_t *const _values, const size_t _count)
+            {
+                _bank.receive(_address);
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    _bank.receive(_values[i]);
+                }
+                _bank.stop();
+            }
+        }
+
+        namespace burst
+        {
+            using core::driver::i2c::register_write_t;
+
+            /* configuration upload of a typical sensor, partly adjacent registers */
+            static uint8_t mode[] = {0x01};
+            static uint8_t rate[] = {0x07};
+            static uint8_t range[] = {0x20, 0x03};
+            static uint8_t filter[] = {0x10, 0x04};
+            static uint8_t irq_enable[] = {0x81};
+            static uint8_t irq_mask[] = {0x0f};
+            static uint8_t irq_level[] = {0x02};
+            static uint8_t offset_a[] = {0x11, 0x22, 0x33, 0x44};
+            static uint8_t offset_b[] = {0x55, 0x66, 0x77, 0x88};
+            static uint8_t fifo[] = {0x40};
+            static uint8_t threshold_low[] = {0x00, 0x10};
+            static uint8_t threshold_high[] = {0xff, 0x70};
+
+            static const register_write_t UPLOAD[] = {
+                {0x10, {mode, sizeof(mode)}},
+                {0x11, {rate, sizeof(rate)}},
+                {0x12, {range, sizeof(range)}},
+                {0x14, {filter, sizeof(filter)}},
+                {0x20, {irq_enable, sizeof(irq_enable)}},
+                {0x21, {irq_mask, sizeof(irq_mask)}},
+                {0x22, {irq_level, sizeof(irq_level)}},
+                {0x30, {offset_a, sizeof(offset_a)}},
+                {0x34, {offset_b, sizeof(offset_b)}},
+                {0x40, {fifo, sizeof(fifo)}},
+                {0x50, {threshold_low, sizeof(threshold_low)}},
+                {0x52, {threshold_high, sizeof(threshold_high)}},
+            };
+            static const size_t COUNT = sizeof(UPLOAD) / sizeof(UPLOAD[0]);
+
+            /* runs the master on the virtual clock until the queue is done, returns the elapsed time */
+            static uint64_t run(core::driver::i2c::AsyncMaster &_master)
+            {
+                const uint64_t start = async::now;
+                while (!_master.is_idle())
+                {
+                    _master.perform();
+                    async::now++;
+                }
+                return async::now - start;
+            }
+
+            static bool uploaded(const uint8_t *const _memory)
+            {
+                for (const register_write_t &entry : UPLOAD)
+                {
+                    if (memcmp(&_memory[entry.location], entry.data.space, entry.data.size) != 0)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        namespace loopback
+        {
+            using core::driver::i2c::status_t;
+            using core::driver::i2c::transaction_t;
+            using Bank = core::driver::i2c::memory::ShadowBank<map::Bank>;
+
+            static const uint8_t TEXT[12] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xf1, 0xe2, 0xd3, 0xc4};
+
+            static uint32_t calls = 0;
+            static Bank::changes_t last = {};
+
+            static void handler(const Bank::changes_t &_changes)
+            {
+                calls++;
+                last = _changes;
+            }
+
+            /* master and slave bank on one simulated bus, no wires between I2C0 and I2C1 */
+            struct Fixture
+            {
+                Bank bank;
+                core::driver::i2c::SlavePort<Bank> port{bank};
+                core::driver::i2c::LoopbackBus bus;
+                core::driver::i2c::AsyncMaster master{bus};
+
+                explicit Fixture(const uint32_t _frequency, const uint32_t _stretch_us = 0) :
+                    bus({_frequency, async::clock})
+                {
+                    bank.initialize();
+                    bus.attach(async::TARGET, port, _stretch_us);
+                    async::now = 0;
+                    master.initialize();
+                }
+
+                ~Fixture()
+                {
+                    master.shutdown();
+                    bank.shutdown();
+                }
+
+                /* register pointer and data, then the read after a repeated start */
+                status_t transfer(const uint8_t _address, const uint8_t _location, const chunk_t &_write, const chunk_t &_read)
+                {
+                    uint8_t buffer[1 + map::Bank::total_size()];
+                    TEST_ASSERT_MESSAGE(_write.size < sizeof(buffer), "write larger than the register map");
+                    buffer[0] = _location;
+                    if (_write.size)
+                    {
+                        memcpy(&buffer[1], _write.space, _write.size);
+                    }
+
+                    transaction_t transaction = {_address, chunk_t{buffer, 1 + _write.size}, _read, nullptr, status_t::IDLE};
+                    master.submit(&transaction);
+                    burst::run(master);
+                    return transaction.status;
+                }
+
+                status_t write(const uint8_t _location, const chunk_t &_data) { return transfer(async::TARGET, _location, _data, chunk_t{nullptr, 0}); }
+                status_t read(const uint8_t _location, const chunk_t &_data) { return transfer(async::TARGET, _location, chunk_t{nullptr, 0}, _data); }
+
+                uint32_t report(const char *const _name) const
+                {
+                    const uint32_t utilization = async::now ? static_cast<uint32_t>(bus.get_busy_us() * 100 / async::now) : 0;
+                    printf("i2c loopback %s: %lu transactions %lu nacks, bus busy %lu of %lu us (%lu%%), %lu us stretched\n",
+                           _name,
+                           bus.get_transactions(),
+                           bus.get_nacks(),
+                           static_cast<uint32_t>(bus.get_busy_us()),
+                           static_cast<uint32_t>(async::now),
+                           utilization,
+                           static_cast<uint32_t>(bus.get_stretch_us()));
+                    return utilization;
+                }
+            };
+        }
+
         record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::INITIALIZE> test_initialize(
             []()
             {
@@ -367,5 +783,820 @@ namespace test::collection
 
                 TEST_ASSERT_MESSAGE(1, "done");
             });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::ASYNC_ORDER> test_async_order(
+            []()
+            {
+                using core::driver::i2c::status_t;
+                using core::driver::i2c::transaction_t;
+
+                uint8_t target_memory[32] = {};
+                uint8_t other_memory[32] = {};
+                for (uint8_t i = 0; i < sizeof(other_memory); ++i)
+                {
+                    other_memory[i] = static_cast<uint8_t>(0xa0 + i);
+                }
+
+                core::driver::i2c::SimulatedBus bus({400000, async::clock});
+                bus.attach(async::TARGET, chunk_t{target_memory, sizeof(target_memory)});
+                bus.attach(async::OTHER, chunk_t{other_memory, sizeof(other_memory)});
+
+                core::driver::i2c::AsyncMaster master(bus);
+                async::now = 0;
+                master.initialize();
+
+                uint8_t first[5] = {0x04, 0xde, 0xad, 0xbe, 0xef};
+                uint8_t second[3] = {0x08, 0x12, 0x34};
+                uint8_t pointer[1] = {0x04};
+                uint8_t other_pointer[1] = {0x08};
+                uint8_t read_back[4] = {};
+                uint8_t read_on[2] = {};
+                uint8_t read_other[3] = {};
+                uint8_t nothing[2] = {};
+
+                transaction_t transactions[] = {
+                    {async::TARGET, chunk_t{first, sizeof(first)}, chunk_t{nullptr, 0}, async::record, status_t::IDLE},
+                    {async::TARGET, chunk_t{second, sizeof(second)}, chunk_t{nullptr, 0}, async::record, status_t::IDLE},
+                    {async::TARGET, chunk_t{pointer, sizeof(pointer)}, chunk_t{read_back, sizeof(read_back)}, async::record, status_t::IDLE},
+                    {async::MISSING, chunk_t{pointer, sizeof(pointer)}, chunk_t{nothing, sizeof(nothing)}, async::record, status_t::IDLE},
+                    {async::OTHER, chunk_t{other_pointer, sizeof(other_pointer)}, chunk_t{read_other, sizeof(read_other)}, async::record, status_t::IDLE},
+                    {async::TARGET, chunk_t{nullptr, 0}, chunk_t{read_on, sizeof(read_on)}, async::record, status_t::IDLE},
+                    {async::TARGET, chunk_t{nullptr, 0}, chunk_t{nullptr, 0}, async::record, status_t::IDLE},
+                };
+                const size_t count = sizeof(transactions) / sizeof(transactions[0]);
+
+                async::base = transactions;
+                async::finished = 0;
+                for (transaction_t &transaction : transactions)
+                {
+                    TEST_ASSERT_MESSAGE(master.submit(&transaction), "queue full");
+                }
+
+                /* the main loop keeps running while the bus works */
+                uint32_t loops = 0;
+                while (!master.is_idle() && async::now < 100000)
+                {
+                    master.perform();
+                    async::now += 10;
+                    loops++;
+                }
+
+                printf("i2c async: %u transactions in %lu us, %lu us bus time, %lu main loop turns\n",
+                       static_cast<unsigned>(count),
+                       static_cast<uint32_t>(async::now),
+                       static_cast<uint32_t>(bus.get_busy_us()),
+                       loops);
+
+                TEST_ASSERT_MESSAGE(async::finished == count, "completion missing");
+                for (size_t i = 0; i < count; ++i)
+                {
+                    TEST_ASSERT_MESSAGE(async::order[i] == i, "completion out of order");
+                }
+
+                TEST_ASSERT_MESSAGE(transactions[0].status == status_t::DONE, "write failed");
+                TEST_ASSERT_MESSAGE(transactions[2].status == status_t::DONE, "write read failed");
+                TEST_ASSERT_MESSAGE(memcmp(read_back, &first[1], sizeof(read_back)) == 0, "wrong data read back");
+                TEST_ASSERT_MESSAGE(transactions[3].status == status_t::NACK, "missing target acknowledged");
+                TEST_ASSERT_MESSAGE(read_other[0] == 0xa8 && read_other[2] == 0xaa, "wrong target read");
+                TEST_ASSERT_MESSAGE(read_on[0] == 0x12 && read_on[1] == 0x34, "read does not continue at the register pointer");
+                TEST_ASSERT_MESSAGE(transactions[6].status == status_t::REJECTED, "empty transaction accepted");
+                TEST_ASSERT_MESSAGE(master.get_completed() == count && master.get_failed() == 2, "wrong counters");
+                TEST_ASSERT_MESSAGE(loops > 10, "main loop blocked");
+
+                master.shutdown();
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::ASYNC_THROUGHPUT> test_async_throughput(
+            []()
+            {
+                using core::driver::i2c::status_t;
+                using core::driver::i2c::transaction_t;
+
+                static const size_t TRANSACTIONS = 200;
+                static const size_t SIZE = 16;
+                static const uint32_t FREQUENCIES[] = {100000, 400000, 1000000};
+
+                uint8_t memory[256] = {};
+                uint8_t data[1 + SIZE];
+                transaction_t transactions[core::driver::i2c::AsyncMaster::QUEUE_SIZE];
+
+                for (const uint32_t frequency : FREQUENCIES)
+                {
+                    core::driver::i2c::SimulatedBus bus({frequency, time_us_64});
+                    bus.attach(async::TARGET, chunk_t{memory, sizeof(memory)});
+
+                    core::driver::i2c::AsyncMaster master(bus);
+                    master.initialize();
+
+                    size_t submitted = 0;
+                    uint32_t work = 0;
+                    const uint64_t start = time_us_64();
+                    while (master.get_completed() < TRANSACTIONS)
+                    {
+                        /* keep the queue filled, the slot of a finished transaction is free again */
+                        while (submitted < TRANSACTIONS && master.get_pending() < core::driver::i2c::AsyncMaster::QUEUE_SIZE)
+                        {
+                            data[0] = static_cast<uint8_t>(submitted * SIZE);
+                            transactions[submitted % core::driver::i2c::AsyncMaster::QUEUE_SIZE] =
+                                transaction_t{async::TARGET, chunk_t{data, sizeof(data)}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE};
+                            master.submit(&transactions[submitted % core::driver::i2c::AsyncMaster::QUEUE_SIZE]);
+                            submitted++;
+                        }
+
+                        master.perform();
+                        work++;
+                    }
+                    const uint64_t duration = time_us_64() - start + 1;
+
+                    printf("i2c async %4lu kHz: %lu transactions/s %lu bytes/s, bus busy %lu%%, %lu main loop turns\n",
+                           frequency / 1000,
+                           static_cast<uint32_t>(TRANSACTIONS * 1000000ull / duration),
+                           static_cast<uint32_t>(TRANSACTIONS * SIZE * 1000000ull / duration),
+                           static_cast<uint32_t>(bus.get_busy_us() * 100 / duration),
+                           work);
+
+                    TEST_ASSERT_MESSAGE(master.get_failed() == 0, "transaction failed");
+                    TEST_ASSERT_MESSAGE(bus.get_busy_us() * 100 / duration > 80, "bus idles between queued transactions");
+
+                    master.shutdown();
+                }
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::ASYNC_DMA> test_async_dma(
+            []()
+            {
+#if PICO_ON_DEVICE
+                using core::driver::i2c::status_t;
+                using core::driver::i2c::transaction_t;
+
+                init_test();
+                until_timer scheduler(-5000);
+
+                core::driver::i2c::memory::DefaultBank default_bank;
+                default_bank.initialize();
+
+                core::driver::i2c::Slave i2c_slave(default_bank);
+                i2c_slave.set_address(async::TARGET);
+                i2c_slave.initialize();
+
+                /* gpio pairs 0/1, 4/5, ... belong to i2c0, 2/3, 6/7, ... to i2c1 */
+                const uint sda = core::driver::i2c::master::Variant::SDA_PIN;
+                const uint scl = core::driver::i2c::master::Variant::SCL_PIN;
+                core::driver::i2c::DmaBus bus({((sda >> 1) & 1) ? i2c1 : i2c0, sda, scl, 100000});
+                core::driver::i2c::AsyncMaster master(bus);
+                master.initialize();
+
+                core::driver::i2c::memory::bla::register_t bla;
+                bla.value.data = 0xbeef;
+                uint8_t write[1 + bla.SIZE] = {static_cast<uint8_t>(bla.ADDRESS)};
+                memcpy(&write[1], bla.byte, bla.SIZE);
+
+                core::driver::i2c::memory::bla::register_t read;
+                uint8_t pointer[1] = {static_cast<uint8_t>(bla.ADDRESS)};
+
+                transaction_t transactions[] = {
+                    {async::TARGET, chunk_t{write, sizeof(write)}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE},
+                    {async::TARGET, chunk_t{pointer, sizeof(pointer)}, chunk_t{read.byte, read.SIZE}, nullptr, status_t::IDLE},
+                };
+                master.submit(&transactions[0]);
+                master.submit(&transactions[1]);
+
+                uint32_t loops = 0;
+                scheduler.perform(
+                    [&master, &loops]()
+                    {
+                        master.perform();
+                        loops++;
+                    });
+
+                printf("i2c async dma: bla 0x%04x slave 0x%04x, %lu main loop turns\n", read.value.data, default_bank.bla_register.value.data, loops);
+
+                master.shutdown();
+                i2c_slave.shutdown();
+                default_bank.shutdown();
+
+                TEST_ASSERT_MESSAGE(transactions[0].status == status_t::DONE && transactions[1].status == status_t::DONE, "transaction failed");
+                TEST_ASSERT_MESSAGE(read.value.data == 0xbeef, "wrong data read back");
+#else
+                TEST_ASSERT_MESSAGE(true, "DMA bus needs the device");
+#endif
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::REGISTER_MAP> test_register_map(
+            []()
+            {
+                namespace memory = core::driver::i2c::memory;
+                static const uint32_t ROUNDS = 1000;
+                static const uint8_t ADDRESSES[] = {static_cast<uint8_t>(memory::bla::register_t::ADDRESS), 0xe5, 0xfe};
+
+                map::check<map::Bank>();
+                map::check<map::Large>();
+
+                TEST_ASSERT_MESSAGE(map::Bank::lookup(static_cast<uint8_t>(memory::serial::register_t::ADDRESS) + 3).offset == 3, "wrong offset");
+                TEST_ASSERT_MESSAGE(map::Bank::total_size() == memory::bla::register_t::SIZE + memory::blub::register_t::SIZE + memory::serial::register_t::SIZE,
+                                    "wrong total size");
+
+                test::collection::details::CycleCounter counter;
+                uint32_t cycles[2][3];
+                volatile uint8_t sink = 0;
+
+                /* best of a few runs, an interrupt in between must not count */
+                const auto measure = [&counter](const auto &_lookup)
+                {
+                    uint32_t best = 0xffffffff;
+                    for (int run = 0; run < 5; ++run)
+                    {
+                        counter.start();
+                        for (uint32_t i = 0; i < ROUNDS; ++i)
+                        {
+                            _lookup();
+                        }
+                        const uint32_t cycles = counter.stop();
+                        best = cycles < best ? cycles : best;
+                    }
+                    return best;
+                };
+
+                /* warm up, the table has to be in the flash cache for every address */
+                measure([&sink]() { sink = static_cast<uint8_t>(sink + map::Large::lookup(sink).index); });
+
+                for (size_t a = 0; a < 3; ++a)
+                {
+                    volatile uint8_t address = ADDRESSES[a];
+                    cycles[0][a] = measure([&sink, &address]() { sink = static_cast<uint8_t>(sink + map::Large::lookup(address).index); });
+                    cycles[1][a] = measure([&sink, &address]() { sink = static_cast<uint8_t>(sink + map::search<map::Large>(address).index); });
+                }
+
+                printf("i2c register map: table %lu/%lu/%lu search %lu/%lu/%lu cycles per %lu lookups (first, last, unknown register)\n",
+                       cycles[0][0],
+                       cycles[0][1],
+                       cycles[0][2],
+                       cycles[1][0],
+                       cycles[1][1],
+                       cycles[1][2],
+                       ROUNDS);
+
+                /* constant time: unknown and last register cost the same as the first one */
+                for (size_t a = 1; a < 3; ++a)
+                {
+                    const uint32_t difference = cycles[0][a] > cycles[0][0] ? cycles[0][a] - cycles[0][0] : cycles[0][0] - cycles[0][a];
+                    TEST_ASSERT_MESSAGE(difference <= cycles[0][0] / 4, "lookup time depends on the address");
+                }
+                TEST_ASSERT_MESSAGE(cycles[0][2] < cycles[1][2], "table lookup slower than a search");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::SHADOW_BANK> test_shadow_bank(
+            []()
+            {
+                static shadow::NaiveBank naive;
+                static core::driver::i2c::memory::ShadowBank<map::Bank> bank;
+
+                const shadow::result_t before = shadow::interleave(naive);
+
+                bank.initialize();
+                const shadow::result_t after = shadow::interleave(bank);
+
+                printf("i2c shadow bank: %lu steps, single copy %lu/%lu torn reads %lu/%lu torn fetches, shadowed %lu/%lu torn reads %lu/%lu torn fetches\n",
+                       shadow::STEPS,
+                       before.torn_reads,
+                       before.reads,
+                       before.torn_fetches,
+                       before.fetches,
+                       after.torn_reads,
+                       after.reads,
+                       after.torn_fetches,
+                       after.fetches);
+
+                TEST_ASSERT_MESSAGE(before.torn_reads > 0 && before.torn_fetches > 0, "interleaving does not provoke torn registers");
+                TEST_ASSERT_MESSAGE(after.reads > 10000 && after.fetches > 10000, "too few transactions");
+                TEST_ASSERT_MESSAGE(after.torn_reads == 0, "master read a torn register");
+                TEST_ASSERT_MESSAGE(after.torn_fetches == 0, "application fetched a torn register");
+
+                /* register memory semantics: pointer set by the first byte, unknown addresses */
+                bank.stop();
+                uint8_t value[12] = {0x11, 0x22, 0x33, 0x44};
+                bank.update(1, chunk_t{value, 4});
+                bank.receive(static_cast<uint8_t>(map::Bank::address_of(1)) + 2);
+                TEST_ASSERT_MESSAGE(bank.request() == 0x33 && bank.request() == 0x44, "read does not start at the register pointer");
+                bank.stop();
+
+                bank.receive(0xfe);
+                bank.receive(0x99);
+                TEST_ASSERT_MESSAGE(bank.request() == 0xff, "unknown register readable");
+                bank.stop();
+
+                bank.fetch(2, value);
+                bank.receive(static_cast<uint8_t>(map::Bank::address_of(2)));
+                bank.receive(0xaa);
+                bank.receive(0xbb);
+                TEST_ASSERT_MESSAGE(!bank.fetch(2, value), "master write visible before STOP");
+                bank.stop();
+                TEST_ASSERT_MESSAGE(bank.fetch(2, value) && value[0] == 0xaa && value[1] == 0xbb, "master write lost");
+                TEST_ASSERT_MESSAGE(!bank.fetch(2, value), "master write fetched twice");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::DIRTY_REGISTERS> test_dirty_registers(
+            []()
+            {
+                static dirty::Bank bank;
+                bank.initialize();
+                bank.set_handler(dirty::handler);
+
+                /* 0x60, 0x61 and the first byte of 0x62 in one transaction */
+                const uint8_t values[] = {0x01, 0x02, 0x03, 0x04};
+                dirty::write(bank, 0x60, values, 3);
+                TEST_ASSERT_MESSAGE(dirty::calls == 1, "no single notification at STOP");
+                TEST_ASSERT_MESSAGE(dirty::last.size() == 3 && dirty::last.contains(9) && dirty::last.contains(10) && dirty::last.contains(11),
+                                    "wrong change set");
+
+                dirty::write(bank, 0x00, values, 4);
+                TEST_ASSERT_MESSAGE(dirty::calls == 2 && dirty::last.size() == 1 && dirty::last.first() == 0, "register bytes not coalesced");
+
+                dirty::write(bank, 0x00, values, 4);
+                TEST_ASSERT_MESSAGE(dirty::calls == 2, "unchanged value notified");
+
+                dirty::write(bank, 0xfe, values, 2);
+                bank.receive(0x00);
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    bank.request();
+                }
+                bank.stop();
+                TEST_ASSERT_MESSAGE(dirty::calls == 2, "read or unmapped write notified");
+
+                /*
+                    the application walks the change set only, a full scan of
+                    the bank must find exactly the same fresh registers
+                */
+                uint8_t value[64];
+                for (size_t i = 0; i < map::Large::COUNT; ++i)
+                {
+                    bank.fetch(i, value);
+                }
+
+                uint32_t random = 4711;
+                uint32_t examined = 0;
+                uint32_t mismatches = 0;
+                const uint32_t TRANSACTIONS = 1000;
+                for (uint32_t transaction = 0; transaction < TRANSACTIONS; ++transaction)
+                {
+                    random = random * 1664525u + 1013904223u;
+                    const size_t index = (random >> 8) % map::Large::COUNT;
+                    const size_t size = map::Large::size_of(index) < 4 ? map::Large::size_of(index) : 4;
+                    const uint8_t payload[4] = {static_cast<uint8_t>(transaction), static_cast<uint8_t>(transaction >> 8), 0x5a, 0xa5};
+
+                    const uint32_t before = dirty::calls;
+                    dirty::write(bank, static_cast<uint8_t>(map::Large::address_of(index)), payload, size);
+                    const dirty::Bank::changes_t changes = dirty::calls != before ? dirty::last : dirty::Bank::changes_t{};
+
+                    for (size_t i = changes.first(); i < map::Large::COUNT; i = changes.next(i))
+                    {
+                        examined++;
+                        mismatches += bank.fetch(i, value) ? 0 : 1;
+                    }
+                    for (size_t i = 0; i < map::Large::COUNT; ++i)
+                    {
+                        mismatches += bank.fetch(i, value) ? 1 : 0;
+                    }
+                }
+
+                printf("i2c dirty registers: %lu transactions, %lu notifications, %lu registers examined instead of %lu\n",
+                       TRANSACTIONS,
+                       dirty::calls,
+                       examined,
+                       TRANSACTIONS * static_cast<uint32_t>(map::Large::COUNT));
+
+                TEST_ASSERT_MESSAGE(mismatches == 0, "change set differs from the fresh registers");
+                TEST_ASSERT_MESSAGE(examined <= TRANSACTIONS && examined > TRANSACTIONS / 2, "change set not limited to the written register");
+                TEST_ASSERT_MESSAGE(bank.get_notifications() == dirty::calls, "notification count");
+
+                bank.shutdown();
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::BURST> test_burst(
+            []()
+            {
+                using core::driver::i2c::status_t;
+                using core::driver::i2c::transaction_t;
+
+                uint8_t memory[128] = {};
+                core::driver::i2c::SimulatedBus bus({400000, async::clock});
+                bus.attach(async::TARGET, chunk_t{memory, sizeof(memory)});
+
+                core::driver::i2c::AsyncMaster master(bus);
+                async::now = 0;
+                master.initialize();
+
+                /* one START, register address, data, STOP per register */
+                uint8_t single[burst::COUNT][8];
+                transaction_t transactions[burst::COUNT];
+                for (size_t i = 0; i < burst::COUNT; ++i)
+                {
+                    single[i][0] = burst::UPLOAD[i].location;
+                    memcpy(&single[i][1], burst::UPLOAD[i].data.space, burst::UPLOAD[i].data.size);
+                    transactions[i] = transaction_t{async::TARGET, chunk_t{single[i], 1 + burst::UPLOAD[i].data.size}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE};
+                    master.submit(&transactions[i]);
+                }
+                const uint64_t single_us = burst::run(master);
+                const uint64_t single_bus_us = bus.get_busy_us();
+                const uint32_t single_count = master.get_completed();
+
+                TEST_ASSERT_MESSAGE(master.get_failed() == 0 && burst::uploaded(memory), "single register upload failed");
+
+                memset(memory, 0, sizeof(memory));
+                master.initialize();
+
+                core::driver::i2c::Burst upload;
+                transaction_t *const head = upload.prepare(async::TARGET, burst::UPLOAD, burst::COUNT, nullptr);
+                TEST_ASSERT_MESSAGE(head && upload.get_links() == 5, "adjacent registers not merged");
+
+                master.submit(head);
+                const uint64_t burst_us = burst::run(master);
+                const uint64_t burst_bus_us = bus.get_busy_us();
+                const uint32_t burst_count = master.get_completed();
+
+                printf("i2c burst upload of %u registers: %lu transactions %lu us bus %lu us, burst %lu transaction (%u links) %lu us bus %lu us\n",
+                       static_cast<unsigned>(burst::COUNT),
+                       single_count,
+                       static_cast<uint32_t>(single_us),
+                       static_cast<uint32_t>(single_bus_us),
+                       burst_count,
+                       static_cast<unsigned>(upload.get_links()),
+                       static_cast<uint32_t>(burst_us),
+                       static_cast<uint32_t>(burst_bus_us));
+
+                TEST_ASSERT_MESSAGE(head->status == status_t::DONE && burst::uploaded(memory), "burst upload failed");
+                TEST_ASSERT_MESSAGE(burst_count == 1, "burst split into transactions");
+                TEST_ASSERT_MESSAGE(burst_bus_us * 4 < single_bus_us * 3, "burst does not save bus time");
+
+                /* limits: too much data, only the last link may read */
+                uint8_t large[core::driver::i2c::Burst::MAX_BYTES] = {};
+                const core::driver::i2c::register_write_t too_large[] = {{0x00, {large, sizeof(large)}}};
+                TEST_ASSERT_MESSAGE(!upload.prepare(async::TARGET, too_large, 1, nullptr), "oversized burst accepted");
+
+                uint8_t location[1] = {0x10};
+                uint8_t value[2] = {};
+                transaction_t tail = {async::TARGET, chunk_t{location, 1}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE};
+                transaction_t reading = {async::TARGET, chunk_t{location, 1}, chunk_t{value, sizeof(value)}, nullptr, status_t::IDLE};
+                reading.chain = &tail;
+                TEST_ASSERT_MESSAGE(!bus.start(&reading), "read inside of a chain accepted");
+
+                tail.chain = nullptr;
+                transaction_t writing = {async::TARGET, chunk_t{location, 1}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE};
+                writing.chain = &reading;
+                reading.chain = nullptr;
+                master.submit(&writing);
+                burst::run(master);
+                TEST_ASSERT_MESSAGE(writing.status == status_t::DONE && value[0] == 0x01 && value[1] == 0x07, "chained read failed");
+
+                master.shutdown();
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::TRACER> test_tracer(
+            []()
+            {
+                using core::driver::i2c::direction_t;
+                using core::driver::i2c::status_t;
+                using core::driver::i2c::Tracer;
+                using core::driver::i2c::transaction_t;
+
+                uint8_t memory[64] = {};
+                core::driver::i2c::SimulatedBus bus({400000, async::clock});
+                bus.attach(async::TARGET, chunk_t{memory, sizeof(memory)});
+
+                static Tracer tracer(async::clock);
+                core::driver::i2c::AsyncMaster master(bus);
+                async::now = 0;
+                master.initialize();
+                master.set_tracer(&tracer);
+
+                uint8_t write[5] = {0x00, 0x01, 0x02, 0x03};
+                uint8_t pointer[1] = {0x00};
+                uint8_t read[8] = {};
+                transaction_t transactions[] = {
+                    {async::TARGET, chunk_t{write, 4}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE},
+                    {async::TARGET, chunk_t{pointer, 1}, chunk_t{read, 8}, nullptr, status_t::IDLE},
+                    {async::TARGET, chunk_t{nullptr, 0}, chunk_t{read, 2}, nullptr, status_t::IDLE},
+                    {async::MISSING, chunk_t{write, 5}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE},
+                    {async::TARGET, chunk_t{nullptr, 0}, chunk_t{nullptr, 0}, nullptr, status_t::IDLE},
+                };
+                for (transaction_t &transaction : transactions)
+                {
+                    master.submit(&transaction);
+                }
+                burst::run(master);
+
+                TEST_ASSERT_MESSAGE(tracer.get_total() == 5 && tracer.get_failed() == 2, "transactions not traced");
+                TEST_ASSERT_MESSAGE(tracer.get(0).status == status_t::REJECTED && tracer.get(0).duration_us == 0, "rejected transaction");
+                TEST_ASSERT_MESSAGE(tracer.get(1).status == status_t::NACK && tracer.get(1).address == async::MISSING, "nack transaction");
+                TEST_ASSERT_MESSAGE(tracer.get(2).direction == direction_t::READ && tracer.get(2).length == 2, "read transaction");
+                TEST_ASSERT_MESSAGE(tracer.get(3).direction == direction_t::WRITE_READ && tracer.get(3).length == 9, "write read transaction");
+                TEST_ASSERT_MESSAGE(tracer.get(4).direction == direction_t::WRITE && tracer.get(4).length == 4 && tracer.get(4).status == status_t::DONE &&
+                                        tracer.get(4).duration_us > 0,
+                                    "write transaction");
+                TEST_ASSERT_MESSAGE(tracer.get_slowest().length == 9, "slowest transaction lost");
+
+                uint32_t latencies = 0;
+                uint32_t sizes = 0;
+                for (size_t bin = 0; bin < Tracer::BINS; ++bin)
+                {
+                    latencies += tracer.get_latency(bin);
+                    sizes += tracer.get_size(bin);
+                }
+                TEST_ASSERT_MESSAGE(latencies == 5 && sizes == 5, "histograms incomplete");
+                TEST_ASSERT_MESSAGE(Tracer::bin_of(0) == 0 && Tracer::bin_of(1) == 1 && Tracer::bin_of(255) == 8 && Tracer::bin_of(256) == 9 &&
+                                        Tracer::bin_of(0xffffffff) == Tracer::BINS - 1,
+                                    "histogram bins");
+
+                tracer.dump();
+
+                /* slave side, one record per transaction up to STOP */
+                static Tracer slave_tracer(async::clock);
+                static core::driver::i2c::memory::ShadowBank<map::Bank> bank;
+                bank.initialize();
+                bank.set_tracer(&slave_tracer, async::TARGET);
+
+                bank.receive(static_cast<uint8_t>(map::Bank::address_of(0)));
+                bank.receive(0x12);
+                bank.receive(0x34);
+                bank.stop();
+
+                bank.receive(static_cast<uint8_t>(map::Bank::address_of(1)));
+                bank.restart();
+                for (size_t i = 0; i < map::Bank::size_of(1); ++i)
+                {
+                    bank.request();
+                }
+                bank.stop();
+
+                bank.receive(0xfe);
+                bank.receive(0x56);
+                bank.stop();
+
+                TEST_ASSERT_MESSAGE(slave_tracer.get_total() == 3 && slave_tracer.get_failed() == 1, "slave transactions not traced");
+                TEST_ASSERT_MESSAGE(slave_tracer.get(2).direction == direction_t::WRITE && slave_tracer.get(2).length == 3, "slave write");
+                TEST_ASSERT_MESSAGE(slave_tracer.get(1).direction == direction_t::WRITE_READ && slave_tracer.get(1).length == 1 + map::Bank::size_of(1),
+                                    "slave write read");
+                TEST_ASSERT_MESSAGE(slave_tracer.get(0).status == status_t::OVERFLOW && slave_tracer.get(0).address == async::TARGET, "slave overflow");
+
+                /* the ring keeps the newest records */
+                tracer.reset();
+                details::CycleCounter counter;
+                counter.start();
+                for (size_t i = 0; i < Tracer::RECORDS + 10; ++i)
+                {
+                    tracer.record(async::TARGET, direction_t::WRITE, i, status_t::DONE, async::now);
+                }
+                const uint32_t cycles = counter.stop();
+
+                printf("i2c tracer: %lu cycles per record\n", cycles / static_cast<uint32_t>(Tracer::RECORDS + 10));
+
+                TEST_ASSERT_MESSAGE(tracer.get_count() == Tracer::RECORDS && tracer.get(0).length == Tracer::RECORDS + 9 &&
+                                        tracer.get(Tracer::RECORDS - 1).length == 10,
+                                    "ring order");
+                TEST_ASSERT_MESSAGE(cycles / (Tracer::RECORDS + 10) < 1000, "tracer too slow for the isr");
+
+                master.shutdown();
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_INITIALIZE> test_loopback_initialize(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+
+                uint8_t value[2] = {0xaa, 0xaa};
+                TEST_ASSERT_MESSAGE(fixture.transfer(async::MISSING, 0x10, chunk_t{nullptr, 0}, chunk_t{value, sizeof(value)}) == loopback::status_t::NACK,
+                                    "missing slave answered");
+                TEST_ASSERT_MESSAGE(fixture.read(0x10, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "slave does not answer");
+                TEST_ASSERT_MESSAGE(value[0] == 0 && value[1] == 0, "bank not initialized");
+                TEST_ASSERT_MESSAGE(fixture.bus.get_transactions() == 2 && fixture.bus.get_nacks() == 1, "bus statistics");
+
+                fixture.report("initialize");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_WRITE> test_loopback_write(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+
+                core::driver::i2c::memory::bla::register_t bla;
+                bla.value.data = 0xbeef;
+                core::driver::i2c::memory::blub::register_t blub;
+                blub.value.x = 0xcafe;
+                blub.value.a = 0x0f;
+                blub.value.b = 0xf0;
+
+                TEST_ASSERT_MESSAGE(fixture.write(static_cast<uint8_t>(bla.ADDRESS), chunk_t{bla.byte, bla.SIZE}) == loopback::status_t::DONE, "bla write");
+                TEST_ASSERT_MESSAGE(fixture.write(static_cast<uint8_t>(blub.ADDRESS), chunk_t{blub.byte, blub.SIZE}) == loopback::status_t::DONE, "blub write");
+
+                uint8_t value[4] = {};
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(0, value) && memcmp(value, bla.byte, bla.SIZE) == 0, "slave bla differs");
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(1, value) && memcmp(value, blub.byte, blub.SIZE) == 0, "slave blub differs");
+
+                fixture.report("write");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_READ> test_loopback_read(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+
+                core::driver::i2c::memory::bla::register_t slave_bla;
+                slave_bla.value.data = 0xbeef;
+                core::driver::i2c::memory::blub::register_t slave_blub;
+                slave_blub.value.x = 0xcafe;
+                slave_blub.value.a = 0x0f;
+                slave_blub.value.b = 0xf0;
+                fixture.bank.update(0, chunk_t{slave_bla.byte, slave_bla.SIZE});
+                fixture.bank.update(1, chunk_t{slave_blub.byte, slave_blub.SIZE});
+
+                core::driver::i2c::memory::bla::register_t bla;
+                core::driver::i2c::memory::blub::register_t blub;
+                TEST_ASSERT_MESSAGE(fixture.read(static_cast<uint8_t>(bla.ADDRESS), chunk_t{bla.byte, bla.SIZE}) == loopback::status_t::DONE, "bla read");
+                TEST_ASSERT_MESSAGE(fixture.read(static_cast<uint8_t>(blub.ADDRESS), chunk_t{blub.byte, blub.SIZE}) == loopback::status_t::DONE, "blub read");
+
+                TEST_ASSERT_MESSAGE(bla.value.data == 0xbeef, "master bla differs");
+                TEST_ASSERT_MESSAGE(blub.value.x == 0xcafe && blub.value.a == 0x0f && blub.value.b == 0xf0, "master blub differs");
+
+                fixture.report("read");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_TEXT> test_loopback_text(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+
+                core::driver::i2c::memory::serial::register_t serial;
+                memcpy(serial.byte, loopback::TEXT, sizeof(loopback::TEXT));
+                TEST_ASSERT_MESSAGE(fixture.write(static_cast<uint8_t>(serial.ADDRESS), chunk_t{serial.byte, serial.SIZE}) == loopback::status_t::DONE,
+                                    "serial write");
+
+                uint8_t value[12] = {};
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, value) && memcmp(value, loopback::TEXT, sizeof(value)) == 0, "slave serial differs");
+
+                for (uint8_t i = 0; i < sizeof(value); ++i)
+                {
+                    value[i] = i;
+                }
+                fixture.bank.update(2, chunk_t{value, sizeof(value)});
+
+                TEST_ASSERT_MESSAGE(fixture.read(static_cast<uint8_t>(serial.ADDRESS), chunk_t{serial.byte, serial.SIZE}) == loopback::status_t::DONE,
+                                    "serial read");
+                TEST_ASSERT_MESSAGE(memcmp(serial.byte, value, sizeof(value)) == 0, "master serial differs");
+
+                fixture.report("text");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_UNKNOWN> test_loopback_unknown(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+                static core::driver::i2c::Tracer tracer(async::clock);
+                tracer.reset();
+                fixture.bank.set_tracer(&tracer, async::TARGET);
+
+                uint8_t value[12];
+                memcpy(value, loopback::TEXT, sizeof(value));
+                TEST_ASSERT_MESSAGE(fixture.write(0xfe, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "unknown register write");
+                TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == 0, "unknown register changed the bank");
+                TEST_ASSERT_MESSAGE(tracer.get(0).status == loopback::status_t::OVERFLOW, "unknown register write not traced");
+
+                TEST_ASSERT_MESSAGE(fixture.read(0xfe, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "unknown register read");
+                for (const uint8_t byte : value)
+                {
+                    TEST_ASSERT_MESSAGE(byte == 0xff, "unknown register readable");
+                }
+
+                fixture.report("unknown");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_OVERFLOW> test_loopback_overflow(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+                static core::driver::i2c::Tracer tracer(async::clock);
+                tracer.reset();
+                fixture.bank.set_tracer(&tracer, async::TARGET);
+
+                /* two bytes more than the serial register, they run into unmapped addresses */
+                uint8_t value[14];
+                memcpy(value, loopback::TEXT, sizeof(loopback::TEXT));
+                value[12] = 0x99;
+                value[13] = 0x98;
+                const uint8_t location = static_cast<uint8_t>(core::driver::i2c::memory::serial::register_t::ADDRESS);
+                TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "overflowing write");
+                TEST_ASSERT_MESSAGE(tracer.get(0).status == loopback::status_t::OVERFLOW, "overflow not traced");
+
+                uint8_t serial[12] = {};
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, serial) && memcmp(serial, loopback::TEXT, sizeof(serial)) == 0, "serial register lost");
+
+                /* master writes and reads use separate copies, the application hands the value back */
+                fixture.bank.update(2, chunk_t{serial, sizeof(serial)});
+                memset(value, 0, sizeof(value));
+                TEST_ASSERT_MESSAGE(fixture.read(location, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "overflowing read");
+                TEST_ASSERT_MESSAGE(memcmp(value, loopback::TEXT, sizeof(loopback::TEXT)) == 0 && value[12] == 0xff && value[13] == 0xff,
+                                    "read beyond the serial register");
+
+                fixture.report("overflow");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_FAULTS> test_loopback_faults(
+            []()
+            {
+                static const uint32_t FREQUENCIES[] = {100000, 400000, 1000000};
+                static const uint32_t STRETCH_US = 20;
+                static const uint32_t TRANSACTIONS = 50;
+                const uint8_t location = static_cast<uint8_t>(core::driver::i2c::memory::serial::register_t::ADDRESS);
+
+                uint8_t value[12];
+                memcpy(value, loopback::TEXT, sizeof(value));
+
+                /* bus speed and clock stretching, 14 acknowledged bytes per transaction */
+                for (const uint32_t frequency : FREQUENCIES)
+                {
+                    for (const uint32_t stretch : {0u, STRETCH_US})
+                    {
+                        loopback::Fixture fixture(frequency, stretch);
+                        for (uint32_t i = 0; i < TRANSACTIONS; ++i)
+                        {
+                            value[0] = static_cast<uint8_t>(i);
+                            TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "write failed");
+                        }
+
+                        char name[32];
+                        snprintf(name, sizeof(name), "%4lu kHz stretch %2lu us", frequency / 1000, stretch);
+                        const uint32_t utilization = fixture.report(name);
+
+                        const uint64_t bits = TRANSACTIONS * (1 + 9 + 9 * 13 + 1);
+                        const uint64_t expected = TRANSACTIONS * 14 * stretch + (bits * 1000000 + TRANSACTIONS * (frequency - 1)) / frequency;
+                        TEST_ASSERT_MESSAGE(fixture.bus.get_stretch_us() == TRANSACTIONS * 14 * stretch, "stretch time");
+                        TEST_ASSERT_MESSAGE(fixture.bus.get_busy_us() <= expected && fixture.bus.get_busy_us() + TRANSACTIONS >= expected, "bus time");
+                        TEST_ASSERT_MESSAGE(utilization >= 50, "master leaves the bus idle");
+                    }
+                }
+
+                /* NAK injection, the bytes before the NAK reach the slave */
+                loopback::Fixture fixture(400000);
+                memcpy(value, loopback::TEXT, sizeof(value));
+                TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "write failed");
+
+                uint8_t changed[12];
+                memset(changed, 0x77, sizeof(changed));
+                fixture.bus.inject_nack(async::TARGET, 5);
+                TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{changed, sizeof(changed)}) == loopback::status_t::NACK, "injected data NAK ignored");
+
+                uint8_t serial[12];
+                fixture.bank.fetch(2, serial);
+                TEST_ASSERT_MESSAGE(memcmp(serial, changed, 3) == 0 && memcmp(&serial[3], &loopback::TEXT[3], 9) == 0, "bytes before the NAK");
+
+                const uint32_t notifications = fixture.bank.get_notifications();
+                fixture.bus.inject_nack(async::TARGET, 0);
+                TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{value, sizeof(value)}) == loopback::status_t::NACK, "injected address NAK ignored");
+                TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == notifications, "NAKed address reached the slave");
+
+                TEST_ASSERT_MESSAGE(fixture.write(location, chunk_t{value, sizeof(value)}) == loopback::status_t::DONE, "NAK injected twice");
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, serial) && memcmp(serial, loopback::TEXT, sizeof(serial)) == 0, "write after NAK");
+
+                fixture.report("nak injection");
+            });
+
+        record::Item<test::GROUP::BASE_I2C, test::base_i2c::IDENTIFIER::LOOPBACK_BURST> test_loopback_burst(
+            []()
+            {
+                loopback::Fixture fixture(400000);
+                loopback::calls = 0;
+                fixture.bank.set_handler(loopback::handler);
+
+                /* the partial serial write is not adjacent, the burst continues after a repeated start */
+                uint8_t bla[core::driver::i2c::memory::bla::register_t::SIZE];
+                uint8_t blub[core::driver::i2c::memory::blub::register_t::SIZE];
+                memset(bla, 0x5a, sizeof(bla));
+                memset(blub, 0xa5, sizeof(blub));
+                uint8_t serial[3];
+                memcpy(serial, &loopback::TEXT[2], sizeof(serial));
+                const core::driver::i2c::register_write_t list[] = {
+                    {static_cast<uint8_t>(core::driver::i2c::memory::bla::register_t::ADDRESS), {bla, sizeof(bla)}},
+                    {static_cast<uint8_t>(core::driver::i2c::memory::blub::register_t::ADDRESS), {blub, sizeof(blub)}},
+                    {static_cast<uint8_t>(core::driver::i2c::memory::serial::register_t::ADDRESS + 2), {serial, sizeof(serial)}},
+                };
+
+                core::driver::i2c::Burst upload;
+                loopback::transaction_t *const head = upload.prepare(async::TARGET, list, 3, nullptr);
+                TEST_ASSERT_MESSAGE(head && upload.get_links() > 1, "burst without a repeated start");
+                fixture.master.submit(head);
+                burst::run(fixture.master);
+                TEST_ASSERT_MESSAGE(head->status == loopback::status_t::DONE, "burst failed");
+
+                /* one transaction, one notification with all registers at STOP */
+                TEST_ASSERT_MESSAGE(loopback::calls == 1 && fixture.bank.get_notifications() == 1, "notified at a repeated start");
+                TEST_ASSERT_MESSAGE(loopback::last.size() == 3, "wrong change set");
+
+                uint8_t value[12] = {};
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(0, value) && memcmp(value, bla, sizeof(bla)) == 0, "slave bla differs");
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(1, value) && memcmp(value, blub, sizeof(blub)) == 0, "slave blub differs");
+                TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, value) && memcmp(&value[2], serial, sizeof(serial)) == 0, "slave serial differs");
+
+                fixture.report("burst");
+            });
     }
 }
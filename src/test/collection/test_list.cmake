@@ -17,6 +17,12 @@ do_test(checksum_crc_post)
 do_test(checksum_crc_reflected)
 do_test(checksum_crc_reflected_post)
 do_test(checksum_hash)
+do_test(checksum_crc_table)
+do_test(checksum_crc_benchmark)
+do_test(checksum_stream)
+do_test(checksum_hash_words)
+do_test(checksum_hash_benchmark)
+do_test(checksum_backend)
 
 do_test(random_sequence_11)
 do_test(random_sequence_32)
@@ -25,6 +31,18 @@ do_test(random_sequence_many)
 
 do_test(serial_echo)
 do_test(serial_cross)
+do_test(serial_dma_cross)
+do_test(serial_dispatch)
+do_test(serial_sim_echo)
+do_test(serial_sim_cross)
+do_test(serial_negotiation)
+do_test(serial_ring_stress)
+do_test(serial_ring_span)
+do_test(serial_ring_copy)
+do_test(serial_ring_benchmark)
+do_test(serial_ring_statistics)
+do_test(serial_packet)
+do_test(serial_packet_benchmark)
 
 do_test(audio_pwm)
 do_test(audio_beep)
@@ -40,6 +58,12 @@ do_test(audio_start)
 do_test(audio_work)
 do_test(audio_multi)
 do_test(audio_theme)
+do_test(audio_wavetable)
+do_test(audio_dma)
+do_test(audio_note_table)
+do_test(audio_queue)
+do_test(audio_melody)
+do_test(audio_render)
 
 do_test(visual_leds)
 do_test(visual_smooth)
@@ -59,6 +83,22 @@ do_test(base_i2c@read)
 do_test(base_i2c@text)
 do_test(base_i2c@unknown)
 do_test(base_i2c@overflow)
+do_test(base_i2c@async_order)
+do_test(base_i2c@async_throughput)
+do_test(base_i2c@async_dma)
+do_test(base_i2c@register_map)
+do_test(base_i2c@shadow_bank)
+do_test(base_i2c@dirty_registers)
+do_test(base_i2c@burst)
+do_test(base_i2c@tracer)
+do_test(base_i2c@loopback_initialize)
+do_test(base_i2c@loopback_write)
+do_test(base_i2c@loopback_read)
+do_test(base_i2c@loopback_text)
+do_test(base_i2c@loopback_unknown)
+do_test(base_i2c@loopback_overflow)
+do_test(base_i2c@loopback_faults)
+do_test(base_i2c@loopback_burst)
 
 do_test(registry_instance)
 
@@ -9,15 +9,26 @@
 #pragma once
 
 #include "bytering.hpp"
+#include "checksum.hpp"
+#include "checksum_stream.hpp"
+#include "packet.hpp"
+#include "spscring.hpp"
+#include "test_cycle_counter.hpp"
 #include "test_record.hpp"
 #include "test_scheduler.hpp"
 #include "test_serial_handler.hpp"
+#include "uart_dispatch.hpp"
+#include "uart_dma.hpp"
+#include "uart_negotiation.hpp"
+#include "uart_sim.hpp"
 #include "uart_instance.hpp"
 #include "unit_identifier.hpp"
 #include "unity.h"
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <pico/multicore.h>
 #include <pico/stdlib.h>
 
 namespace test::collection
@@ -44,6 +55,186 @@ namespace test::collection
                 bytering_copy(_rx, &buffer_b);
                 bytering_copy(&buffer_a, _tx);
             }
+
+            namespace dma
+            {
+                /* wiring: GPIO0 (uart0 tx) to GPIO5 (uart1 rx), GPIO1 (uart0 rx) to GPIO4 (uart1 tx) */
+                static const uint BAUDRATE = 1000000;
+                static const size_t SIZE = 1024;
+                static const core::driver::uart::dispatch_t DISPATCH = {SIZE / 4, core::driver::uart::NO_DELIMITER, 100};
+
+                alignas(SIZE) static uint8_t first_rx[SIZE];
+                alignas(SIZE) static uint8_t second_rx[SIZE];
+                static uint8_t first_tx[SIZE];
+                static uint8_t second_tx[SIZE];
+
+                static uint32_t sent = 0;
+                static uint32_t received = 0;
+                static uint32_t wrong = 0;
+
+                static uint8_t value(const uint32_t _index)
+                {
+                    return static_cast<uint8_t>(_index ^ (_index >> 8));
+                }
+
+                static void echo(spscring_t *const _rx, spscring_t *const _tx)
+                {
+                    spscring_copy(_rx, _tx);
+                }
+
+                static void check(spscring_t *const _rx, spscring_t *const)
+                {
+                    spscring_span_t span;
+                    const size_t count = spscring_read_acquire(_rx, &span);
+                    for (const chunk_t &piece : span.piece)
+                    {
+                        for (size_t i = 0; i < piece.size; ++i)
+                        {
+                            wrong += (piece.space[i] != value(received)) ? 1 : 0;
+                            received++;
+                        }
+                    }
+                    spscring_read_commit(_rx, count);
+                }
+            }
+
+            namespace sim
+            {
+                static const uint32_t BAUDRATE = 115200;
+                static const uint64_t STEP_US = 5;
+                static const uint64_t DURATION_US = 200000;
+                static const size_t SIZE = 256;
+                static const core::driver::uart::dispatch_t DISPATCH = {16, core::driver::uart::NO_DELIMITER, 200};
+
+                static uint8_t first_rx[SIZE];
+                static uint8_t second_rx[SIZE];
+                static uint8_t first_tx[SIZE];
+                static uint8_t second_tx[SIZE];
+
+                static uint64_t now = 0;
+                static uint32_t received[2] = {0, 0};
+
+                static uint64_t clock()
+                {
+                    return now;
+                }
+
+                static void echo(spscring_t *const _rx, spscring_t *const _tx)
+                {
+                    spscring_copy(_rx, _tx);
+                }
+
+                template <size_t INDEX>
+                static void count(spscring_t *const _rx, spscring_t *const)
+                {
+                    received[INDEX] += static_cast<uint32_t>(spscring_count(_rx));
+                    spscring_read_commit(_rx, spscring_count(_rx));
+                }
+
+                static void report(const char *const _name, const core::driver::uart::SimulatedDevice &_device, const uint64_t _wall_us)
+                {
+                    const core::driver::uart::sim_statistics_t &statistics = _device.get_statistics();
+                    printf("serial sim %s: %lu delivered %lu lost %lu overflows, line %lu bytes/s, cpu %lu bytes/s, latency avg %lu max %lu us\n",
+                           _name,
+                           statistics.delivered,
+                           statistics.lost,
+                           statistics.overflows,
+                           static_cast<uint32_t>(static_cast<uint64_t>(statistics.delivered) * 1000000 / DURATION_US),
+                           static_cast<uint32_t>(static_cast<uint64_t>(statistics.delivered) * 1000000 / (_wall_us + 1)),
+                           static_cast<uint32_t>(statistics.latency_count ? statistics.latency_sum / statistics.latency_count : 0),
+                           statistics.latency_max);
+                }
+            }
+
+            namespace negotiation
+            {
+                static const uint32_t DEFAULT_RATE = 115200;
+                static const uint32_t FIRST_RATES[] = {460800, 921600, 3000000};
+                static const uint32_t SECOND_RATES[] = {460800, 921600};
+
+                /* loopback stand-in: the faster the line, the more bytes get lost */
+                static uint32_t loss(const uint32_t _baudrate)
+                {
+                    return _baudrate <= 460800 ? 0 : (_baudrate <= 921600 ? 200 : 900000);
+                }
+
+                /* takes one byte every fourth call, slower than the line */
+                static void slow(spscring_t *const _rx, spscring_t *const)
+                {
+                    static uint32_t calls = 0;
+                    uint8_t value;
+                    if ((++calls & 3) == 0 && spscring_pop(_rx, &value))
+                    {
+                        sim::received[0]++;
+                    }
+                }
+
+                template <typename NEGOTIATOR>
+                static void run(core::driver::uart::SimulatedDevice &_first, core::driver::uart::SimulatedDevice &_second, NEGOTIATOR &_a, NEGOTIATOR &_b)
+                {
+                    _a.start();
+                    _b.start();
+                    for (const uint64_t end = sim::now + 500000; sim::now < end && !(_a.is_done() && _b.is_done()); sim::now += sim::STEP_US)
+                    {
+                        _first.perform();
+                        _second.perform();
+                        _a.perform();
+                        _b.perform();
+                    }
+
+                    /* the last PROBE is still on its way, an application would skip it as a packet */
+                    for (const uint64_t end = sim::now + 5000; sim::now < end; sim::now += sim::STEP_US)
+                    {
+                        _first.perform();
+                        _second.perform();
+                    }
+                    spscring_read_commit(_first.get_rx(), spscring_count(_first.get_rx()));
+                    spscring_read_commit(_second.get_rx(), spscring_count(_second.get_rx()));
+                }
+            }
+
+            namespace stress
+            {
+                static const uint32_t BYTES = 20000000;
+                static const uint32_t BLOCK = 13;
+                static const uint64_t TIMEOUT_US = 60000000;
+
+                static uint8_t space[256];
+                static spscring_t ring;
+
+                static uint8_t value(const uint32_t _index)
+                {
+                    return static_cast<uint8_t>(_index ^ (_index >> 8) ^ (_index >> 16));
+                }
+
+                /* core1, bytewise and block pushes take turns */
+                static void producer()
+                {
+                    uint8_t block[BLOCK];
+                    uint32_t index = 0;
+
+                    while (index < BYTES)
+                    {
+                        if (index & 0x400)
+                        {
+                            if (spscring_push(&ring, value(index)))
+                            {
+                                index++;
+                            }
+                        }
+                        else
+                        {
+                            uint32_t size = BYTES - index < BLOCK ? BYTES - index : BLOCK;
+                            for (uint32_t i = 0; i < size; ++i)
+                            {
+                                block[i] = value(index + i);
+                            }
+                            const chunk_t chunk = {block, size};
+                            index += static_cast<uint32_t>(spscring_write(&ring, &chunk));
+                        }
+                    }
+                }
+            }
         }
 
         record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::ECHO> test_serial_echo(
@@ -108,5 +299,729 @@ namespace test::collection
 
                 TEST_ASSERT_MESSAGE(1, "done");
             });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::DMA_CROSS> test_serial_dma_cross(
+            []()
+            {
+                namespace dma = details::dma;
+
+                until_timer scheduler(-1000, 10000);
+
+                core::driver::uart::DmaDevice first_device(
+                    {uart0, 0, 1, dma::BAUDRATE, dma::DISPATCH, chunk_t{dma::first_rx, dma::SIZE}, chunk_t{dma::first_tx, dma::SIZE}});
+                core::driver::uart::DmaDevice second_device(
+                    {uart1, 4, 5, dma::BAUDRATE, dma::DISPATCH, chunk_t{dma::second_rx, dma::SIZE}, chunk_t{dma::second_tx, dma::SIZE}});
+
+                first_device.set_handler(dma::check);
+                second_device.set_handler(dma::echo);
+
+                first_device.initialize();
+                second_device.initialize();
+
+                dma::sent = 0;
+                dma::received = 0;
+                dma::wrong = 0;
+
+                const uint64_t start = time_us_64();
+                scheduler.perform(
+                    [&first_device, &second_device]()
+                    {
+                        /* keep the transmitter busy, the rest is DMA */
+                        spscring_span_t span;
+                        spscring_t *const tx = first_device.get_tx();
+                        const size_t space = spscring_write_acquire(tx, &span);
+                        for (const chunk_t &piece : span.piece)
+                        {
+                            for (size_t i = 0; i < piece.size; ++i)
+                            {
+                                piece.space[i] = dma::value(dma::sent++);
+                            }
+                        }
+                        spscring_write_commit(tx, space);
+
+                        second_device.perform();
+                        first_device.perform();
+                    });
+
+                /* drain what is still on the line */
+                const uint64_t stop = time_us_64();
+                while (dma::received < dma::sent && time_us_64() - stop < 100000)
+                {
+                    second_device.perform();
+                    first_device.perform();
+                }
+                const uint64_t duration = stop - start;
+
+                printf("serial dma: %lu sent %lu received %lu wrong %lu overflows at %u baud, %lu bytes/s\n",
+                       dma::sent,
+                       dma::received,
+                       dma::wrong,
+                       first_device.get_overflows() + second_device.get_overflows(),
+                       first_device.get_baudrate(),
+                       static_cast<uint32_t>(static_cast<uint64_t>(dma::received) * 1000000 / duration));
+                printf("serial dma: handler calls %lu/%lu, saved %lu/%lu\n",
+                       first_device.get_calls(),
+                       second_device.get_calls(),
+                       first_device.get_saved(),
+                       second_device.get_saved());
+
+                second_device.shutdown();
+                first_device.shutdown();
+
+                TEST_ASSERT_MESSAGE(dma::received == dma::sent, "bytes lost");
+                TEST_ASSERT_MESSAGE(dma::wrong == 0, "bytes corrupted");
+                TEST_ASSERT_MESSAGE(first_device.get_overflows() + second_device.get_overflows() == 0, "receiver overflow");
+                TEST_ASSERT_MESSAGE(static_cast<uint64_t>(dma::received) * 1000000 / duration > dma::BAUDRATE / 10 * 9 / 10, "below line rate");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::DISPATCH> test_serial_dispatch(
+            []()
+            {
+                using core::driver::uart::Dispatcher;
+                using core::driver::uart::dispatch_t;
+                using core::driver::uart::NO_DELIMITER;
+
+                uint8_t space[64];
+                spscring_t ring;
+
+                /* simulated line: one byte every 10us, a quiet gap of 500us after every 16 bytes */
+                const auto run = [&ring, &space](Dispatcher &_dispatcher, const size_t _bytes)
+                {
+                    spscring_init(&ring, chunk_t{space, sizeof(space)});
+                    _dispatcher.reset();
+
+                    uint64_t now = 0;
+                    for (size_t i = 0; i < _bytes; ++i)
+                    {
+                        /* one perform per microsecond, the handler empties the ring */
+                        for (int j = 0; j < 10; ++j, ++now)
+                        {
+                            if (_dispatcher.update(&ring, 0, now))
+                            {
+                                spscring_read_commit(&ring, spscring_count(&ring));
+                            }
+                        }
+
+                        spscring_push(&ring, (i % 16 == 15) ? '\n' : 'x');
+                        if (_dispatcher.update(&ring, 1, now))
+                        {
+                            spscring_read_commit(&ring, spscring_count(&ring));
+                        }
+
+                        if (i % 16 == 15)
+                        {
+                            for (int j = 0; j < 500; ++j, ++now)
+                            {
+                                if (_dispatcher.update(&ring, 0, now))
+                                {
+                                    spscring_read_commit(&ring, spscring_count(&ring));
+                                }
+                            }
+                        }
+                    }
+                };
+
+                Dispatcher every({1, NO_DELIMITER, 0});
+                Dispatcher threshold({8, NO_DELIMITER, 0});
+                Dispatcher delimiter({0, '\n', 0});
+                Dispatcher timeout({0, NO_DELIMITER, 100});
+                Dispatcher half({0, NO_DELIMITER, 0});
+
+                run(every, 160);
+                run(threshold, 160);
+                run(delimiter, 160);
+                run(timeout, 160);
+                run(half, 160);
+
+                printf("serial dispatch calls/saved: every %lu/%lu threshold %lu/%lu delimiter %lu/%lu timeout %lu/%lu half %lu/%lu\n",
+                       every.get_calls(),
+                       every.get_saved(),
+                       threshold.get_calls(),
+                       threshold.get_saved(),
+                       delimiter.get_calls(),
+                       delimiter.get_saved(),
+                       timeout.get_calls(),
+                       timeout.get_saved(),
+                       half.get_calls(),
+                       half.get_saved());
+
+                TEST_ASSERT_MESSAGE(every.get_calls() == 160, "wrong call count for threshold 1");
+                TEST_ASSERT_MESSAGE(threshold.get_calls() == 20, "wrong call count for threshold");
+                TEST_ASSERT_MESSAGE(delimiter.get_calls() == 10, "wrong call count for delimiter");
+                TEST_ASSERT_MESSAGE(timeout.get_calls() == 10, "wrong call count for timeout");
+                TEST_ASSERT_MESSAGE(half.get_calls() == 5, "wrong call count for a half full ring");
+                TEST_ASSERT_MESSAGE(timeout.get_saved() + timeout.get_calls() == every.get_saved() + every.get_calls(), "saved calls not counted");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::SIM_ECHO> test_serial_sim_echo(
+            []()
+            {
+                namespace sim = details::sim;
+
+                core::driver::uart::SimulatedDevice first_device(
+                    {sim::BAUDRATE, 0, 1, sim::clock, sim::DISPATCH, chunk_t{sim::first_rx, sim::SIZE}, chunk_t{sim::first_tx, sim::SIZE}});
+                core::driver::uart::SimulatedDevice second_device(
+                    {sim::BAUDRATE, 0, 2, sim::clock, sim::DISPATCH, chunk_t{sim::second_rx, sim::SIZE}, chunk_t{sim::second_tx, sim::SIZE}});
+
+                first_device.connect(second_device);
+                first_device.set_handler(details::dma::check);
+                second_device.set_handler(sim::echo);
+
+                sim::now = 0;
+                first_device.initialize();
+                second_device.initialize();
+
+                details::dma::sent = 0;
+                details::dma::received = 0;
+                details::dma::wrong = 0;
+
+                const uint64_t start = time_us_64();
+                for (; sim::now < sim::DURATION_US; sim::now += sim::STEP_US)
+                {
+                    spscring_t *const tx = first_device.get_tx();
+                    while (spscring_push(tx, details::dma::value(details::dma::sent)))
+                    {
+                        details::dma::sent++;
+                    }
+
+                    second_device.perform();
+                    first_device.perform();
+                }
+                const uint64_t wall = time_us_64() - start;
+
+                sim::report("echo", second_device, wall);
+                sim::report("back", first_device, wall);
+
+                const uint32_t line = static_cast<uint32_t>(static_cast<uint64_t>(first_device.get_statistics().delivered) * 1000000 / sim::DURATION_US);
+
+                first_device.shutdown();
+                second_device.shutdown();
+
+                TEST_ASSERT_MESSAGE(details::dma::wrong == 0, "bytes corrupted");
+                TEST_ASSERT_MESSAGE(first_device.get_statistics().lost + second_device.get_statistics().lost == 0, "bytes lost without loss injection");
+                TEST_ASSERT_MESSAGE(line > sim::BAUDRATE / 10 * 9 / 10, "below line rate");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::SIM_CROSS> test_serial_sim_cross(
+            []()
+            {
+                namespace sim = details::sim;
+                static const uint32_t LOSS_PPM = 10000;
+
+                core::driver::uart::SimulatedDevice first_device(
+                    {sim::BAUDRATE, LOSS_PPM, 1, sim::clock, sim::DISPATCH, chunk_t{sim::first_rx, sim::SIZE}, chunk_t{sim::first_tx, sim::SIZE}});
+                core::driver::uart::SimulatedDevice second_device(
+                    {sim::BAUDRATE, LOSS_PPM, 2, sim::clock, sim::DISPATCH, chunk_t{sim::second_rx, sim::SIZE}, chunk_t{sim::second_tx, sim::SIZE}});
+
+                first_device.connect(second_device);
+                first_device.set_handler(sim::count<0>);
+                second_device.set_handler(sim::count<1>);
+
+                sim::now = 0;
+                sim::received[0] = 0;
+                sim::received[1] = 0;
+                first_device.initialize();
+                second_device.initialize();
+
+                const uint64_t start = time_us_64();
+                for (; sim::now < sim::DURATION_US; sim::now += sim::STEP_US)
+                {
+                    while (spscring_push(first_device.get_tx(), 0x55))
+                    {
+                    }
+                    while (spscring_push(second_device.get_tx(), 0xaa))
+                    {
+                    }
+
+                    second_device.perform();
+                    first_device.perform();
+                }
+                const uint64_t wall = time_us_64() - start;
+
+                sim::report("first", first_device, wall);
+                sim::report("second", second_device, wall);
+
+                first_device.shutdown();
+                second_device.shutdown();
+
+                for (const core::driver::uart::SimulatedDevice *device : {&first_device, &second_device})
+                {
+                    const core::driver::uart::sim_statistics_t &statistics = device->get_statistics();
+                    const uint32_t total = statistics.delivered + statistics.lost;
+
+                    TEST_ASSERT_MESSAGE(statistics.overflows == 0, "receiver overflow");
+                    TEST_ASSERT_MESSAGE(statistics.lost > total / 200 && statistics.lost < total / 50, "loss rate out of range");
+                }
+                TEST_ASSERT_MESSAGE(first_device.get_statistics().sent == second_device.get_statistics().delivered + second_device.get_statistics().lost, "bytes vanished");
+                TEST_ASSERT_MESSAGE(sim::received[1] + spscring_count(second_device.get_rx()) == second_device.get_statistics().delivered, "handler missed bytes");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::NEGOTIATION> test_serial_negotiation(
+            []()
+            {
+                namespace sim = details::sim;
+                namespace negotiation = details::negotiation;
+                using core::driver::uart::negotiation_t;
+                using Negotiator = core::driver::uart::Negotiator<core::driver::uart::SimulatedDevice>;
+
+                core::driver::uart::SimulatedDevice first_device({negotiation::DEFAULT_RATE,
+                                                                  0,
+                                                                  1,
+                                                                  sim::clock,
+                                                                  sim::DISPATCH,
+                                                                  chunk_t{sim::first_rx, sim::SIZE},
+                                                                  chunk_t{sim::first_tx, sim::SIZE},
+                                                                  negotiation::loss,
+                                                                  true});
+                core::driver::uart::SimulatedDevice second_device({negotiation::DEFAULT_RATE,
+                                                                   0,
+                                                                   2,
+                                                                   sim::clock,
+                                                                   sim::DISPATCH,
+                                                                   chunk_t{sim::second_rx, sim::SIZE},
+                                                                   chunk_t{sim::second_tx, sim::SIZE},
+                                                                   negotiation::loss,
+                                                                   true});
+                first_device.connect(second_device);
+
+                sim::now = 0;
+                first_device.initialize();
+                second_device.initialize();
+
+                /* fastest common rate */
+                Negotiator first(first_device, {negotiation::FIRST_RATES, 3, negotiation::DEFAULT_RATE, 5000, 50000, 3, 10, sim::clock});
+                Negotiator second(second_device, {negotiation::SECOND_RATES, 2, negotiation::DEFAULT_RATE, 5000, 50000, 3, 10, sim::clock});
+                negotiation::run(first_device, second_device, first, second);
+
+                printf("serial negotiation: %lu/%lu baud after %lu us\n", first.get_rate(), second.get_rate(), static_cast<uint32_t>(sim::now));
+                TEST_ASSERT_MESSAGE(first.get_state() == negotiation_t::LINKED && second.get_state() == negotiation_t::LINKED, "link not established");
+                TEST_ASSERT_MESSAGE(first.get_rate() == 921600 && second.get_rate() == 921600, "not the fastest common rate");
+
+                /* bulk transfer against a slow consumer, RTS/CTS keeps the receiver from overflowing */
+                sim::received[0] = 0;
+                second_device.set_handler(negotiation::slow);
+                uint32_t sent = 0;
+                for (const uint64_t end = sim::now + 50000; sim::now < end; sim::now += sim::STEP_US)
+                {
+                    while (sent < 4000 && spscring_push(first_device.get_tx(), 0x5a))
+                    {
+                        sent++;
+                    }
+                    first_device.perform();
+                    second_device.perform();
+                }
+                second_device.set_handler(nullptr);
+
+                printf("serial negotiation: flow control %lu sent %lu received %lu lost %lu overflows\n",
+                       sent,
+                       sim::received[0],
+                       second_device.get_statistics().lost,
+                       second_device.get_overflows());
+                TEST_ASSERT_MESSAGE(second_device.get_overflows() == 0, "receiver overflow with flow control");
+                const size_t in_flight = spscring_count(first_device.get_tx()) + spscring_count(second_device.get_rx());
+                TEST_ASSERT_MESSAGE(sim::received[0] + second_device.get_statistics().lost + in_flight == sent, "bytes vanished");
+
+                /* errors on the running link, both ends watch their own receive errors */
+                TEST_ASSERT_MESSAGE(!second.supervise(second_device.get_errors()), "fall back on a clean link");
+                TEST_ASSERT_MESSAGE(!first.supervise(5), "fall back below the error limit");
+                TEST_ASSERT_MESSAGE(!first.supervise(15), "fall back at the error limit");
+                TEST_ASSERT_MESSAGE(first.supervise(16), "no fall back above the error limit");
+                TEST_ASSERT_MESSAGE(first.get_rate() == negotiation::DEFAULT_RATE, "not back at the default rate");
+
+                /* the peer reads garbage from now on and follows */
+                bool followed = false;
+                for (const uint64_t end = sim::now + 50000; sim::now < end && !followed; sim::now += sim::STEP_US)
+                {
+                    spscring_push(first_device.get_tx(), 0x55);
+                    first_device.perform();
+                    second_device.perform();
+                    spscring_read_commit(second_device.get_rx(), spscring_count(second_device.get_rx()));
+                    followed = second.supervise(second_device.get_errors());
+                }
+                printf("serial negotiation: %lu/%lu baud after %lu framing errors\n", first.get_rate(), second.get_rate(), second_device.get_errors());
+                TEST_ASSERT_MESSAGE(followed && second.get_rate() == negotiation::DEFAULT_RATE, "peer stays at the fast rate");
+
+                /* a common rate that does not work */
+                Negotiator greedy_first(first_device, {negotiation::FIRST_RATES, 3, negotiation::DEFAULT_RATE, 5000, 50000, 3, 10, sim::clock});
+                Negotiator greedy_second(second_device, {negotiation::FIRST_RATES, 3, negotiation::DEFAULT_RATE, 5000, 50000, 3, 10, sim::clock});
+                negotiation::run(first_device, second_device, greedy_first, greedy_second);
+
+                printf("serial negotiation: %lu/%lu baud after probing 3000000\n", greedy_first.get_rate(), greedy_second.get_rate());
+                TEST_ASSERT_MESSAGE(greedy_first.get_state() == negotiation_t::FALLBACK && greedy_second.get_state() == negotiation_t::FALLBACK, "no fall back");
+                TEST_ASSERT_MESSAGE(greedy_first.get_rate() == negotiation::DEFAULT_RATE && greedy_second.get_rate() == negotiation::DEFAULT_RATE, "not back at the default rate");
+
+                first_device.shutdown();
+                second_device.shutdown();
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::RING_STRESS> test_serial_ring_stress(
+            []()
+            {
+                namespace stress = details::stress;
+
+                TEST_ASSERT_MESSAGE(spscring_init(&stress::ring, chunk_t{stress::space, sizeof(stress::space)}), "ring init failed");
+                TEST_ASSERT_MESSAGE(!spscring_init(&stress::ring, chunk_t{stress::space, 100}), "ring accepts a size which is no power of two");
+                TEST_ASSERT_MESSAGE(spscring_init(&stress::ring, chunk_t{stress::space, sizeof(stress::space)}), "ring init failed");
+
+                uint32_t received = 0;
+                uint32_t wrong = 0;
+                uint8_t block[stress::BLOCK + 4];
+
+                const uint64_t start = time_us_64();
+                multicore_launch_core1(stress::producer);
+
+                while (received < stress::BYTES && time_us_64() - start < stress::TIMEOUT_US)
+                {
+                    if (received & 0x800)
+                    {
+                        uint8_t value;
+                        if (spscring_pop(&stress::ring, &value))
+                        {
+                            wrong += (value != stress::value(received)) ? 1 : 0;
+                            received++;
+                        }
+                    }
+                    else
+                    {
+                        chunk_t chunk = {block, sizeof(block)};
+                        const size_t size = spscring_read(&stress::ring, &chunk);
+                        for (size_t i = 0; i < size; ++i)
+                        {
+                            wrong += (block[i] != stress::value(received)) ? 1 : 0;
+                            received++;
+                        }
+                    }
+                }
+
+                const uint64_t duration = time_us_64() - start;
+                multicore_reset_core1();
+
+                printf("serial ring stress: %lu bytes, %lu wrong, %lu us, %lu bytes/s\n",
+                       received,
+                       wrong,
+                       static_cast<uint32_t>(duration),
+                       static_cast<uint32_t>(static_cast<uint64_t>(received) * 1000000 / (duration ? duration : 1)));
+
+                TEST_ASSERT_MESSAGE(received == stress::BYTES, "bytes lost");
+                TEST_ASSERT_MESSAGE(wrong == 0, "bytes duplicated or reordered");
+                TEST_ASSERT_MESSAGE(spscring_is_empty(&stress::ring), "bytes left in ring");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::RING_SPAN> test_serial_ring_span(
+            []()
+            {
+                uint8_t space[64];
+                uint8_t message[40];
+                spscring_t ring;
+                spscring_span_t span;
+
+                for (uint8_t i = 0; i < sizeof(message); ++i)
+                {
+                    message[i] = static_cast<uint8_t>(0xa0 + i);
+                }
+
+                TEST_ASSERT_MESSAGE(spscring_init(&ring, chunk_t{space, sizeof(space)}), "ring init failed");
+
+                /* move the indices close to the end so the next message wraps */
+                TEST_ASSERT_MESSAGE(spscring_write_acquire(&ring, &span) == 64, "wrong writable size");
+                TEST_ASSERT_MESSAGE(span.piece[1].size == 0, "unexpected second span");
+                spscring_write_commit(&ring, 50);
+                spscring_read_commit(&ring, 50);
+
+                /* producer fills the ring memory directly */
+                TEST_ASSERT_MESSAGE(spscring_write_acquire(&ring, &span) == 64, "wrong writable size after wrap");
+                TEST_ASSERT_MESSAGE(span.piece[0].size == 14 && span.piece[1].size == 50, "wrong writable spans");
+                memcpy(span.piece[0].space, message, span.piece[0].size);
+                memcpy(span.piece[1].space, &message[span.piece[0].size], sizeof(message) - span.piece[0].size);
+                spscring_write_commit(&ring, sizeof(message));
+
+                /* consumer checks the frame in place, without copying it out */
+                TEST_ASSERT_MESSAGE(spscring_read_acquire(&ring, &span) == sizeof(message), "wrong readable size");
+                TEST_ASSERT_MESSAGE(span.piece[0].size == 14 && span.piece[1].size == 26, "wrong readable spans");
+
+                checksum_context_t crc;
+                checksum_init(&crc, CHECKSUM_STREAM_CRC, 0);
+                checksum_update_sequence(&crc, span.piece, 2);
+
+                chunk_t whole = {message, sizeof(message)};
+                TEST_ASSERT_MESSAGE(checksum_finalize(&crc) == checksum_crc(&whole, 0), "span content differs");
+
+                /* partial consume, the rest stays readable */
+                spscring_read_commit(&ring, 20);
+                TEST_ASSERT_MESSAGE(spscring_read_acquire(&ring, &span) == 20, "wrong rest after partial commit");
+                TEST_ASSERT_MESSAGE(span.piece[0].space[0] == message[20] && span.piece[1].size == 0, "wrong rest span");
+
+                /* commits are clamped to the acquired region */
+                spscring_read_commit(&ring, 1000);
+                TEST_ASSERT_MESSAGE(spscring_is_empty(&ring), "ring not empty");
+                spscring_write_commit(&ring, 1000);
+                TEST_ASSERT_MESSAGE(spscring_is_full(&ring), "ring not full");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::RING_COPY> test_serial_ring_copy(
+            []()
+            {
+                uint8_t space_a[64];
+                uint8_t space_b[32];
+                spscring_t source;
+                spscring_t destination;
+
+                /* every wrap position on both sides, destination partly filled */
+                for (size_t source_offset = 0; source_offset < sizeof(space_a); source_offset += 5)
+                {
+                    for (size_t destination_offset = 0; destination_offset < sizeof(space_b); destination_offset += 3)
+                    {
+                        spscring_init(&source, chunk_t{space_a, sizeof(space_a)});
+                        spscring_init(&destination, chunk_t{space_b, sizeof(space_b)});
+                        spscring_write_commit(&source, source_offset);
+                        spscring_read_commit(&source, source_offset);
+                        spscring_write_commit(&destination, destination_offset);
+                        spscring_read_commit(&destination, destination_offset);
+
+                        const uint8_t busy = static_cast<uint8_t>(destination_offset % 7);
+                        for (uint8_t i = 0; i < busy; ++i)
+                        {
+                            spscring_push(&destination, 0xee);
+                        }
+
+                        for (uint8_t i = 0; i < 50; ++i)
+                        {
+                            spscring_push(&source, i);
+                        }
+
+                        const size_t copied = spscring_copy(&source, &destination);
+                        TEST_ASSERT_MESSAGE(copied == sizeof(space_b) - busy, "wrong copy size");
+                        TEST_ASSERT_MESSAGE(spscring_count(&source) == 50 - copied, "wrong source rest");
+                        TEST_ASSERT_MESSAGE(spscring_is_full(&destination), "destination not full");
+
+                        uint8_t value = 0;
+                        for (uint8_t i = 0; i < busy; ++i)
+                        {
+                            spscring_pop(&destination, &value);
+                            TEST_ASSERT_MESSAGE(value == 0xee, "destination content overwritten");
+                        }
+                        for (uint8_t i = 0; i < copied; ++i)
+                        {
+                            spscring_pop(&destination, &value);
+                            TEST_ASSERT_MESSAGE(value == i, "wrong copied content");
+                        }
+                        spscring_peek(&source, 0, &value);
+                        TEST_ASSERT_MESSAGE(value == copied, "wrong source order");
+                    }
+                }
+
+                printf("serial ring copy: done\n");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::RING_BENCHMARK> test_serial_ring_benchmark(
+            []()
+            {
+                static const size_t SIZES[] = {64, 256, 1024, 4096};
+                static uint8_t space_a[4096];
+                static uint8_t space_b[4096];
+
+                spscring_t source;
+                spscring_t destination;
+                test::collection::details::CycleCounter counter;
+
+                for (const size_t size : SIZES)
+                {
+                    uint32_t cycles[2] = {0, 0};
+
+                    for (int method = 0; method < 2; ++method)
+                    {
+                        spscring_init(&source, chunk_t{space_a, size});
+                        spscring_init(&destination, chunk_t{space_b, size});
+
+                        /* start in the middle so both rings wrap */
+                        spscring_write_commit(&source, size / 2 + 3);
+                        spscring_read_commit(&source, size / 2 + 3);
+                        spscring_write_commit(&destination, size / 3);
+                        spscring_read_commit(&destination, size / 3);
+                        spscring_write_commit(&source, size);
+
+                        counter.start();
+                        if (method == 0)
+                        {
+                            uint8_t value;
+                            while (spscring_pop(&source, &value))
+                            {
+                                spscring_push(&destination, value);
+                            }
+                        }
+                        else
+                        {
+                            spscring_copy(&source, &destination);
+                        }
+                        cycles[method] = counter.stop();
+
+                        TEST_ASSERT_MESSAGE(spscring_count(&destination) == size, "ring transfer incomplete");
+                    }
+
+                    printf("serial ring %4u bytes: bytewise %lu.%02lu copy %lu.%02lu cycles/byte\n",
+                           static_cast<unsigned>(size),
+                           cycles[0] / size,
+                           (cycles[0] % size) * 100 / size,
+                           cycles[1] / size,
+                           (cycles[1] % size) * 100 / size);
+
+                    TEST_ASSERT_MESSAGE(cycles[1] < cycles[0], "bulk copy is not faster");
+                }
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::RING_STATISTICS> test_serial_ring_statistics(
+            []()
+            {
+                uint8_t space[8];
+                uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+                spscring_t ring;
+                spscring_statistics_t statistics;
+
+                spscring_init(&ring, chunk_t{space, sizeof(space)});
+
+                const chunk_t message = {data, sizeof(data)};
+                spscring_write(&ring, &message);
+                spscring_push(&ring, 0xff);
+
+                chunk_t received = {data, 5};
+                spscring_read(&ring, &received);
+
+                uint8_t value;
+                while (spscring_pop(&ring, &value))
+                {
+                }
+
+                spscring_statistics(&ring, &statistics);
+                printf("serial ring statistics: peak %lu overflows %lu rejected %lu written %lu underruns %lu read %lu\n",
+                       statistics.peak,
+                       statistics.overflows,
+                       statistics.rejected,
+                       statistics.written,
+                       statistics.underruns,
+                       statistics.read);
+
+#if SPSCRING_STATISTICS
+                TEST_ASSERT_MESSAGE(statistics.peak == 8, "wrong peak fill level");
+                TEST_ASSERT_MESSAGE(statistics.overflows == 2, "wrong overflow count");
+                TEST_ASSERT_MESSAGE(statistics.rejected == 3, "wrong rejected count");
+                TEST_ASSERT_MESSAGE(statistics.written == 8, "wrong written count");
+                TEST_ASSERT_MESSAGE(statistics.underruns == 1, "wrong underrun count");
+                TEST_ASSERT_MESSAGE(statistics.read == 8, "wrong read count");
+#else
+                TEST_ASSERT_MESSAGE(statistics.peak == 0 && statistics.written == 0, "statistics without SPSCRING_STATISTICS");
+#endif
+
+                spscring_statistics_reset(&ring);
+                spscring_statistics(&ring, &statistics);
+                TEST_ASSERT_MESSAGE(statistics.peak == 0 && statistics.overflows == 0 && statistics.read == 0, "statistics not reset");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::PACKET> test_serial_packet(
+            []()
+            {
+                static const size_t SIZES[] = {0, 1, 7, 253, 254, 255, 300, 600};
+                static uint8_t space[1024];
+                static uint8_t data[600];
+
+                spscring_t ring;
+                spscring_span_t payload;
+                core::packet::Receiver receiver;
+
+                spscring_init(&ring, chunk_t{space, sizeof(space)});
+
+                for (size_t round = 0; round < 4; ++round)
+                {
+                    for (const size_t size : SIZES)
+                    {
+                        /* zeros and long non zero runs exercise every code length */
+                        for (size_t i = 0; i < size; ++i)
+                        {
+                            data[i] = (round & 1) ? static_cast<uint8_t>(i % 5 ? i + round : 0) : static_cast<uint8_t>(0x80 | i);
+                        }
+
+                        const chunk_t message = {data, size};
+                        TEST_ASSERT_MESSAGE(core::packet::transmit(&ring, &message), "packet does not fit");
+                        TEST_ASSERT_MESSAGE(receiver.receive(&ring, &payload), "packet not received");
+
+                        const size_t length = payload.piece[0].size + payload.piece[1].size;
+                        TEST_ASSERT_MESSAGE(length == size, "wrong payload size");
+                        TEST_ASSERT_MESSAGE(memcmp(payload.piece[0].space, data, payload.piece[0].size) == 0, "wrong payload");
+                        TEST_ASSERT_MESSAGE(memcmp(payload.piece[1].space, data + payload.piece[0].size, payload.piece[1].size) == 0, "wrong payload");
+
+                        receiver.release(&ring);
+                        TEST_ASSERT_MESSAGE(spscring_is_empty(&ring), "frame not consumed");
+                    }
+                }
+
+                /* damage a frame in the ring, the following frame must survive */
+                const chunk_t message = {data, 32};
+                core::packet::transmit(&ring, &message);
+                spscring_span_t frame;
+                spscring_read_acquire(&ring, &frame);
+                if (frame.piece[0].size > 5)
+                {
+                    frame.piece[0].space[5] ^= 0x10;
+                }
+                else
+                {
+                    frame.piece[1].space[5 - frame.piece[0].size] ^= 0x10;
+                }
+                core::packet::transmit(&ring, &message);
+
+                TEST_ASSERT_MESSAGE(receiver.receive(&ring, &payload), "no resync after damaged frame");
+                receiver.release(&ring);
+
+                /* a partial frame waits for its delimiter */
+                spscring_push(&ring, 0x03);
+                spscring_push(&ring, 0x11);
+                TEST_ASSERT_MESSAGE(!receiver.receive(&ring, &payload), "incomplete frame received");
+                spscring_push(&ring, 0x22);
+                spscring_push(&ring, core::packet::DELIMITER);
+                TEST_ASSERT_MESSAGE(!receiver.receive(&ring, &payload), "frame without crc received");
+
+                printf("serial packet: %lu packets %lu errors\n", receiver.get_packets(), receiver.get_errors());
+                TEST_ASSERT_MESSAGE(receiver.get_packets() == 4 * sizeof(SIZES) / sizeof(SIZES[0]) + 1, "wrong packet count");
+                TEST_ASSERT_MESSAGE(receiver.get_errors() == 2, "wrong error count");
+            });
+
+        record::Item<test::GROUP::SERIAL, test::serial::IDENTIFIER::PACKET_BENCHMARK> test_serial_packet_benchmark(
+            []()
+            {
+                static const size_t SIZES[] = {16, 64, 256};
+                static const uint32_t PACKETS = 2000;
+                static uint8_t space[1024];
+                static uint8_t data[256];
+
+                spscring_t ring;
+                spscring_span_t payload;
+                core::packet::Receiver receiver;
+
+                for (size_t i = 0; i < sizeof(data); ++i)
+                {
+                    data[i] = static_cast<uint8_t>(i * 7);
+                }
+
+                for (const size_t size : SIZES)
+                {
+                    spscring_init(&ring, chunk_t{space, sizeof(space)});
+                    const chunk_t message = {data, size};
+
+                    const uint64_t start = time_us_64();
+                    for (uint32_t i = 0; i < PACKETS; ++i)
+                    {
+                        core::packet::transmit(&ring, &message);
+                        receiver.receive(&ring, &payload);
+                        receiver.release(&ring);
+                    }
+                    const uint64_t duration = time_us_64() - start + 1;
+
+                    printf("serial packet %3u bytes: %lu packets/s %lu kbytes/s\n",
+                           static_cast<unsigned>(size),
+                           static_cast<unsigned long>(PACKETS * 1000000ull / duration),
+                           static_cast<unsigned long>(PACKETS * size * 1000ull / duration));
+                }
+
+                TEST_ASSERT_MESSAGE(receiver.get_errors() == 0, "packet errors in benchmark");
+            });
     }
 }
@@ -0,0 +1,198 @@
+/**
+ * \file host_audio.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "audio_halves.hpp"
+#include "audio_render.hpp"
+#include "audio_synth.hpp"
+#include "audio_theme.hpp"
+#include "test_host.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace
+{
+    namespace audio = core::driver::audio;
+    namespace theme = core::driver::audio::theme;
+    namespace jitter = core::driver::audio::jitter;
+    using audio::Recorder;
+    using audio::tone_t;
+
+    /* recorder rate of the goldens, DmaAudio rate and half for the jitter model */
+    static const uint32_t RATE = 8000;
+    static const uint32_t DMA_RATE = 32000;
+    static const size_t HALF = 256;
+
+    /* the wav, the note log and one summary line per sequence go to the working directory, ctest diffs them with golden/ */
+    static FILE *file = nullptr;
+
+    static void write(const uint8_t *const _data, const size_t _size) { fwrite(_data, 1, _size, file); }
+
+    static Recorder::write_t open(const char *const _name, const char *const _extension)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "audio_%s.%s", _name, _extension);
+        file = fopen(name, "wb");
+        TEST_ASSERT_MESSAGE(file, "output not writable");
+        return write;
+    }
+
+    static void close()
+    {
+        fclose(file);
+        file = nullptr;
+    }
+
+    template <size_t NOTES>
+    static void render(FILE *const _summary, const char *const _name, const audio::Melody<NOTES> &_melody)
+    {
+        Recorder recorder({RATE, 255, &audio::wave::SINE});
+
+        const size_t samples = recorder.record(_melody.view(), open(_name, "wav"));
+        close();
+        recorder.log(open(_name, "csv"));
+        close();
+
+        fprintf(_summary, "%s,%u,0x%04x,%u\n", _name, static_cast<unsigned>(samples), recorder.get_crc(), static_cast<unsigned>(recorder.get_notes()));
+        printf("audio render %s: %u samples, crc 0x%04x, %u notes\n",
+               _name,
+               static_cast<unsigned>(samples),
+               recorder.get_crc(),
+               static_cast<unsigned>(recorder.get_notes()));
+
+        /* onsets at the summed up durations */
+        uint32_t elapsed_ms = 0;
+        for (size_t i = 0; i < recorder.get_notes(); ++i)
+        {
+            const audio::onset_t &onset = recorder.get_onset(i);
+            TEST_ASSERT_MESSAGE(onset.sample == elapsed_ms * RATE / 1000, "note onset off");
+            elapsed_ms += onset.duration_ms;
+        }
+    }
+
+    template <size_t NOTES>
+    static void decode(const audio::Melody<NOTES> &_melody, tone_t (&_tones)[NOTES])
+    {
+        const audio::melody_view_t view = _melody.view();
+        for (size_t i = 0; i < NOTES; ++i)
+        {
+            _tones[i] = view.at(i);
+        }
+    }
+
+    void test_golden()
+    {
+        FILE *const summary = fopen("audio_render.txt", "w");
+        TEST_ASSERT_MESSAGE(summary, "summary not writable");
+
+        render(summary, "fanfare", theme::FANFARE);
+        render(summary, "ode_to_joy", theme::ODE_TO_JOY);
+        render(summary, "imperial_march", theme::IMPERIAL_MARCH);
+        fclose(summary);
+    }
+
+    void test_wav_header()
+    {
+        uint8_t header[audio::wav::HEADER];
+        audio::wav::header(header, RATE, 100);
+        TEST_ASSERT_MESSAGE(memcmp(header, "RIFF", 4) == 0 && header[4] == 236 && memcmp(&header[8], "WAVEfmt ", 8) == 0 && header[40] == 200,
+                            "wav header");
+    }
+
+    void test_schedule()
+    {
+        static const tone_t TONE[] = {{1000, 1000, audio::FULL_VOLUME}};
+
+        audio::Synthesizer synthesizer({DMA_RATE, 255, &audio::wave::SQUARE});
+        audio::HalfSchedule schedule(HALF);
+
+        size_t halves[8] = {};
+        uint64_t slots[8] = {};
+        size_t refills = 0;
+        const auto refill = [&](const size_t _half, const uint64_t _slot)
+        {
+            uint16_t levels[HALF];
+            synthesizer.render(levels, HALF);
+            halves[refills] = _half;
+            slots[refills++] = _slot;
+        };
+
+        synthesizer.play(TONE, 1);
+        schedule.start(refill);
+        TEST_ASSERT_MESSAGE(refills == 2 && halves[0] == 0 && halves[1] == 1 && synthesizer.get_position() == 2 * HALF, "start renders both halves");
+
+        /* slot 2 is due once the DMA plays slot 1, not before */
+        schedule.update(0, synthesizer, refill);
+        TEST_ASSERT_MESSAGE(refills == 2, "refilled too early");
+        schedule.update(1, synthesizer, refill);
+        TEST_ASSERT_MESSAGE(refills == 3 && halves[2] == 0 && slots[2] == 2, "slot 2 not refilled");
+
+        /* back while the DMA plays slot 5: slots 3 to 5 replayed old content, slot 6 keeps its samples */
+        schedule.update(5, synthesizer, refill);
+        TEST_ASSERT_MESSAGE(refills == 4 && halves[3] == 0 && slots[3] == 6, "slot 6 not refilled");
+        TEST_ASSERT_MESSAGE(schedule.get_underruns() == 3, "missed slots not counted");
+        TEST_ASSERT_MESSAGE(synthesizer.get_position() == 7 * HALF, "sequence off the time line of the DMA");
+    }
+
+    void test_jitter()
+    {
+        tone_t tones[decltype(theme::FANFARE)::size()];
+        decode(theme::FANFARE, tones);
+        const size_t count = sizeof(tones) / sizeof(tone_t);
+
+        /* perform() cadence against note onsets, halves of 256 samples at 32 kHz last 8 ms */
+        const jitter::cadence_t cadences[] = {{1000, 0, 1}, {1000, 900, 2}, {5000, 2500, 3}, {6000, 5000, 4}};
+
+        jitter::drift_t loop[4];
+        jitter::drift_t sample[4];
+        for (size_t i = 0; i < 4; ++i)
+        {
+            loop[i] = jitter::loop_driven(tones, count, cadences[i]);
+            sample[i] = jitter::sample_based(tones, count, DMA_RATE, HALF, cadences[i]);
+            printf("audio render jitter %u+-%u us: loop driven %u/%u us, sample based %u/%u us, %u underruns (max/mean drift)\n",
+                   cadences[i].period_us,
+                   cadences[i].jitter_us,
+                   loop[i].max_us,
+                   loop[i].mean_us,
+                   sample[i].max_us,
+                   sample[i].mean_us,
+                   sample[i].underruns);
+            TEST_ASSERT_MESSAGE(loop[i].notes == sample[i].notes, "onsets missing");
+        }
+
+        TEST_ASSERT_MESSAGE(sample[0].max_us == 0 && sample[1].max_us == 0 && sample[2].max_us == 0, "sample based onsets drift");
+        TEST_ASSERT_MESSAGE(sample[2].underruns == 0, "underrun below the half duration");
+        TEST_ASSERT_MESSAGE(loop[1].max_us > loop[0].max_us && loop[2].max_us > loop[1].max_us, "loop driven drift does not grow with the cadence");
+        TEST_ASSERT_MESSAGE(sample[3].underruns > 0 && sample[3].max_us <= 8000, "sample based drift adds up over underruns");
+        TEST_ASSERT_MESSAGE(loop[3].max_us > sample[3].max_us, "loop driven onsets drift less than sample based ones");
+
+        /* perform() every five halves: all slots but the first two and the one refilled per call replay old content */
+        uint32_t duration_ms = 0;
+        for (const tone_t &tone : tones)
+        {
+            duration_ms += tone.duration_ms;
+        }
+        const uint32_t halves = static_cast<uint32_t>((static_cast<uint64_t>(duration_ms) * DMA_RATE / 1000 + HALF - 1) / HALF);
+        const jitter::drift_t laps = jitter::sample_based(tones, count, DMA_RATE, HALF, {40000, 0, 5});
+        printf("audio render jitter 40000 us: sample based %u/%u us, %u underruns\n", laps.max_us, laps.mean_us, laps.underruns);
+        TEST_ASSERT_MESSAGE(laps.notes == sample[0].notes, "onsets missing after several laps");
+        TEST_ASSERT_MESSAGE(laps.underruns == halves - 2 - (halves - 1) / 5, "missed halves not counted");
+        TEST_ASSERT_MESSAGE(laps.max_us < 40000, "sample based onsets fall behind over several laps");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"audio render golden", test_golden},
+        {"audio render wav header", test_wav_header},
+        {"audio half schedule", test_schedule},
+        {"audio render jitter", test_jitter},
+    };
+    return test::host::run(CASES);
+}
@@ -0,0 +1,153 @@
+/**
+ * \file host_checksum.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "checksum_words.hpp"
+#include "test_host.hpp"
+
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    using namespace core::checksum::words;
+
+    static const size_t PATTERN_SIZE = 4096;
+    static uint8_t pattern[PATTERN_SIZE + 4];
+
+    static void fill_pattern()
+    {
+        uint32_t state = 0x12345678;
+        for (size_t i = 0; i < sizeof(pattern); ++i)
+        {
+            state = state * 1664525 + 1013904223;
+            pattern[i] = static_cast<uint8_t>(state >> 24);
+        }
+    }
+
+    /* time stamp counter where the host has one, nanoseconds otherwise */
+    static uint64_t ticks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    template <typename STEP>
+    void check_equivalence()
+    {
+        uint32_t state = 0xcafebeef;
+        for (int round = 0; round < 20000; ++round)
+        {
+            state = state * 1664525 + 1013904223;
+            const size_t offset = (state >> 8) & 0x3;
+            const size_t size = (state >> 12) % (PATTERN_SIZE - 4);
+            const chunk_t c = {&pattern[offset], size};
+
+            TEST_ASSERT_MESSAGE(walk_words(&c, STEP::SEED, STEP()) == walk_bytes(&c, STEP::SEED, STEP()), "word walk differs");
+        }
+
+        /* short chunks around every alignment */
+        for (size_t offset = 0; offset < 4; ++offset)
+        {
+            for (size_t size = 0; size < 12; ++size)
+            {
+                const chunk_t c = {&pattern[offset], size};
+                TEST_ASSERT_MESSAGE(walk_words(&c, STEP::SEED, STEP()) == walk_bytes(&c, STEP::SEED, STEP()), "short word walk differs");
+            }
+        }
+    }
+
+    void test_equivalence()
+    {
+        fill_pattern();
+        check_equivalence<one_at_a_time>();
+        check_equivalence<fnv1a>();
+
+        /* published FNV-1a vectors anchor the step, at every start alignment */
+        uint8_t text[12];
+        for (size_t offset = 0; offset < 4; ++offset)
+        {
+            memcpy(&text[offset], "afoobar", 7);
+            const chunk_t empty = {&text[offset], 0};
+            const chunk_t a = {&text[offset], 1};
+            const chunk_t foobar = {&text[offset + 1], 6};
+            TEST_ASSERT_MESSAGE(hash<fnv1a>(&empty) == 0x811c9dc5, "fnv1a empty");
+            TEST_ASSERT_MESSAGE(hash<fnv1a>(&a) == 0xe40c292c, "fnv1a a");
+            TEST_ASSERT_MESSAGE(hash<fnv1a>(&foobar) == 0xbf9cf968, "fnv1a foobar");
+        }
+    }
+
+    template <typename STEP, typename WALK>
+    uint64_t best_of(const chunk_t &_chunk, WALK _walk)
+    {
+        static const int RUNS = 200;
+
+        volatile uint32_t sink = 0;
+        uint64_t best = UINT64_MAX;
+        for (int run = 0; run < RUNS; ++run)
+        {
+            const uint64_t start = ticks();
+            sink = _walk(&_chunk, STEP::SEED, STEP());
+            const uint64_t elapsed = ticks() - start;
+            best = elapsed < best ? elapsed : best;
+        }
+        (void)sink;
+        return best ? best : 1;
+    }
+
+    template <typename STEP>
+    void benchmark(const char *const _name)
+    {
+        static const size_t SIZES[] = {16, 256, PATTERN_SIZE};
+
+        for (const size_t size : SIZES)
+        {
+            const chunk_t c = {&pattern[0], size};
+            const chunk_t shifted = {&pattern[1], size};
+
+            const uint64_t bytes = best_of<STEP>(c, walk_bytes<STEP>);
+            const uint64_t words = best_of<STEP>(c, walk_words<STEP>);
+            const uint64_t unaligned = best_of<STEP>(shifted, walk_words<STEP>);
+
+            /* bytes per tick in hundredths */
+            printf("checksum hash %s %4u bytes: byte walk %u.%02u, word walk %u.%02u, unaligned word walk %u.%02u bytes/cycle\n",
+                   _name,
+                   static_cast<unsigned>(size),
+                   static_cast<unsigned>(size * 100 / bytes / 100),
+                   static_cast<unsigned>(size * 100 / bytes % 100),
+                   static_cast<unsigned>(size * 100 / words / 100),
+                   static_cast<unsigned>(size * 100 / words % 100),
+                   static_cast<unsigned>(size * 100 / unaligned / 100),
+                   static_cast<unsigned>(size * 100 / unaligned % 100));
+        }
+    }
+
+    /* numbers only, a host compiler merges byte loads on its own and the timing is not stable enough to assert */
+    void test_benchmark()
+    {
+        fill_pattern();
+        benchmark<one_at_a_time>("one at a time");
+        benchmark<fnv1a>("fnv1a");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"checksum hash word walk", test_equivalence},
+        {"checksum hash benchmark", test_benchmark},
+    };
+    return test::host::run(CASES);
+}
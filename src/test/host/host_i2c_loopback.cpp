@@ -0,0 +1,358 @@
+/**
+ * \file host_i2c_loopback.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "i2c_async.hpp"
+#include "i2c_burst.hpp"
+#include "i2c_bus.hpp"
+#include "i2c_register_map.hpp"
+#include "i2c_shadow_bank.hpp"
+#include "i2c_trace.hpp"
+#include "test_host.hpp"
+
+#include <initializer_list>
+#include <stdint.h>
+#include <string.h>
+
+namespace
+{
+    namespace memory = core::driver::i2c::memory;
+    using core::driver::i2c::status_t;
+    using core::driver::i2c::transaction_t;
+
+    /*
+        one host case per base_i2c loopback scenario of the board (initialize,
+        write, read, text, unknown, overflow, faults, burst); the register
+        types of the board come with zero, here a map of the same shape
+        stands in: id, control and a serial number, 0x06..0x0f and 0x1c..
+        are unmapped
+    */
+    using Map = memory::RegisterMap<memory::describe<0x00, 4>, memory::describe<0x04, 2>, memory::describe<0x10, 12>>;
+    using Bank = memory::ShadowBank<Map>;
+
+    static const uint8_t TARGET = 0x55;
+    static const uint8_t MISSING = 0x57;
+    static const uint8_t ID = 0x00;
+    static const uint8_t CONTROL = 0x04;
+    static const uint8_t SERIAL = 0x10;
+    static const uint8_t UNKNOWN = 0x80;
+    static const uint8_t TEXT[12] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xf1, 0xe2, 0xd3, 0xc4};
+
+    static uint64_t now = 0;
+
+    static uint64_t clock()
+    {
+        return now;
+    }
+
+    static uint32_t calls = 0;
+    static Bank::changes_t last = {};
+
+    static void handler(const Bank::changes_t &_changes)
+    {
+        calls++;
+        last = _changes;
+    }
+
+    /* master and slave bank on one simulated bus */
+    struct Fixture
+    {
+        Bank bank;
+        core::driver::i2c::SlavePort<Bank> port{bank};
+        core::driver::i2c::LoopbackBus bus;
+        core::driver::i2c::AsyncMaster master{bus};
+
+        explicit Fixture(const uint32_t _frequency, const uint32_t _stretch_us = 0) :
+            bus({_frequency, clock})
+        {
+            bank.initialize();
+            bus.attach(TARGET, port, _stretch_us);
+            now = 0;
+            master.initialize();
+        }
+
+        ~Fixture()
+        {
+            master.shutdown();
+            bank.shutdown();
+        }
+
+        status_t run(transaction_t *const _transaction)
+        {
+            master.submit(_transaction);
+            while (!master.is_idle())
+            {
+                master.perform();
+                now++;
+            }
+            return _transaction->status;
+        }
+
+        /* register pointer and data, then the read after a repeated start */
+        status_t transfer(const uint8_t _address, const uint8_t _location, const chunk_t &_write, const chunk_t &_read)
+        {
+            uint8_t buffer[1 + Map::total_size()];
+            TEST_ASSERT_MESSAGE(_write.size < sizeof(buffer), "write larger than the register map");
+            buffer[0] = _location;
+            if (_write.size)
+            {
+                memcpy(&buffer[1], _write.space, _write.size);
+            }
+
+            transaction_t transaction = {_address, chunk_t{buffer, 1 + _write.size}, _read, nullptr, status_t::IDLE};
+            return run(&transaction);
+        }
+
+        status_t write(const uint8_t _location, const chunk_t &_data) { return transfer(TARGET, _location, _data, chunk_t{nullptr, 0}); }
+        status_t read(const uint8_t _location, const chunk_t &_data) { return transfer(TARGET, _location, chunk_t{nullptr, 0}, _data); }
+
+        /* simulated bus utilization, \return busy time in percent of the elapsed time */
+        uint32_t report(const char *const _name) const
+        {
+            const uint32_t utilization = now ? static_cast<uint32_t>(bus.get_busy_us() * 100 / now) : 0;
+            printf("i2c loopback %s: %u transactions %u nacks, bus busy %u of %u us (%u%%), %u us stretched\n",
+                   _name,
+                   bus.get_transactions(),
+                   bus.get_nacks(),
+                   static_cast<uint32_t>(bus.get_busy_us()),
+                   static_cast<uint32_t>(now),
+                   utilization,
+                   static_cast<uint32_t>(bus.get_stretch_us()));
+            return utilization;
+        }
+    };
+
+    void test_initialize()
+    {
+        Fixture fixture(400000);
+
+        uint8_t value[2] = {0xaa, 0xaa};
+        TEST_ASSERT_MESSAGE(fixture.transfer(MISSING, CONTROL, chunk_t{nullptr, 0}, chunk_t{value, sizeof(value)}) == status_t::NACK, "missing slave answered");
+        TEST_ASSERT_MESSAGE(fixture.read(CONTROL, chunk_t{value, sizeof(value)}) == status_t::DONE, "slave does not answer");
+        TEST_ASSERT_MESSAGE(value[0] == 0 && value[1] == 0, "bank not initialized");
+        TEST_ASSERT_MESSAGE(fixture.bus.get_transactions() == 2 && fixture.bus.get_nacks() == 1, "bus statistics");
+
+        fixture.report("initialize");
+    }
+
+    void test_write()
+    {
+        Fixture fixture(400000);
+
+        uint8_t id[4] = {0xef, 0xbe, 0x00, 0x00};
+        uint8_t control[2] = {0x0f, 0xf0};
+        TEST_ASSERT_MESSAGE(fixture.write(ID, chunk_t{id, sizeof(id)}) == status_t::DONE, "id write");
+        TEST_ASSERT_MESSAGE(fixture.write(CONTROL, chunk_t{control, sizeof(control)}) == status_t::DONE, "control write");
+
+        uint8_t value[4] = {};
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(0, value) && memcmp(value, id, sizeof(id)) == 0, "slave id differs");
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(1, value) && memcmp(value, control, sizeof(control)) == 0, "slave control differs");
+        TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == 2, "one write, one notification");
+
+        fixture.report("write");
+    }
+
+    void test_read()
+    {
+        Fixture fixture(400000);
+
+        uint8_t slave_id[4] = {0xef, 0xbe, 0x00, 0x00};
+        uint8_t slave_control[2] = {0x0f, 0xf0};
+        fixture.bank.update(0, chunk_t{slave_id, sizeof(slave_id)});
+        fixture.bank.update(1, chunk_t{slave_control, sizeof(slave_control)});
+
+        uint8_t id[4] = {};
+        uint8_t control[2] = {};
+        TEST_ASSERT_MESSAGE(fixture.read(ID, chunk_t{id, sizeof(id)}) == status_t::DONE, "id read");
+        TEST_ASSERT_MESSAGE(fixture.read(CONTROL, chunk_t{control, sizeof(control)}) == status_t::DONE, "control read");
+        TEST_ASSERT_MESSAGE(memcmp(id, slave_id, sizeof(id)) == 0, "master id differs");
+        TEST_ASSERT_MESSAGE(memcmp(control, slave_control, sizeof(control)) == 0, "master control differs");
+
+        fixture.report("read");
+    }
+
+    void test_text()
+    {
+        Fixture fixture(400000);
+
+        uint8_t value[12] = {};
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{const_cast<uint8_t *>(TEXT), sizeof(TEXT)}) == status_t::DONE, "serial write");
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, value) && memcmp(value, TEXT, sizeof(value)) == 0, "slave serial differs");
+        TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == 1, "one write, one notification");
+
+        for (uint8_t i = 0; i < sizeof(value); ++i)
+        {
+            value[i] = i;
+        }
+        fixture.bank.update(2, chunk_t{value, sizeof(value)});
+
+        uint8_t serial[12] = {};
+        TEST_ASSERT_MESSAGE(fixture.read(SERIAL, chunk_t{serial, sizeof(serial)}) == status_t::DONE, "serial read");
+        TEST_ASSERT_MESSAGE(memcmp(serial, value, sizeof(value)) == 0, "master serial differs");
+
+        /* the same value again does not notify */
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{const_cast<uint8_t *>(TEXT), sizeof(TEXT)}) == status_t::DONE, "serial rewrite");
+        TEST_ASSERT_MESSAGE(!fixture.bank.fetch(2, value) && fixture.bank.get_notifications() == 1, "unchanged value notified");
+
+        fixture.report("text");
+    }
+
+    void test_unknown()
+    {
+        Fixture fixture(400000);
+        static core::driver::i2c::Tracer tracer(clock);
+        tracer.reset();
+        fixture.bank.set_tracer(&tracer, TARGET);
+
+        uint8_t value[12];
+        memcpy(value, TEXT, sizeof(value));
+        TEST_ASSERT_MESSAGE(fixture.write(UNKNOWN, chunk_t{value, sizeof(value)}) == status_t::DONE, "unknown register write");
+        TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == 0, "unknown register changed the bank");
+        TEST_ASSERT_MESSAGE(tracer.get(0).status == status_t::OVERFLOW, "unknown register write not traced");
+
+        TEST_ASSERT_MESSAGE(fixture.read(UNKNOWN, chunk_t{value, sizeof(value)}) == status_t::DONE, "unknown register read");
+        for (const uint8_t byte : value)
+        {
+            TEST_ASSERT_MESSAGE(byte == 0xff, "unknown register readable");
+        }
+
+        fixture.report("unknown");
+    }
+
+    void test_overflow()
+    {
+        Fixture fixture(400000);
+        static core::driver::i2c::Tracer tracer(clock);
+        tracer.reset();
+        fixture.bank.set_tracer(&tracer, TARGET);
+
+        /* two bytes more than the serial register, they run into unmapped addresses */
+        uint8_t value[14];
+        memcpy(value, TEXT, sizeof(TEXT));
+        value[12] = 0x99;
+        value[13] = 0x98;
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{value, sizeof(value)}) == status_t::DONE, "overflowing write");
+        TEST_ASSERT_MESSAGE(tracer.get(0).status == status_t::OVERFLOW, "overflow not traced");
+
+        uint8_t serial[12] = {};
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, serial) && memcmp(serial, TEXT, sizeof(serial)) == 0, "serial register lost");
+
+        /* master writes and reads use separate copies, the application hands the value back */
+        fixture.bank.update(2, chunk_t{serial, sizeof(serial)});
+        memset(value, 0, sizeof(value));
+        TEST_ASSERT_MESSAGE(fixture.read(SERIAL, chunk_t{value, sizeof(value)}) == status_t::DONE, "overflowing read");
+        TEST_ASSERT_MESSAGE(memcmp(value, TEXT, sizeof(TEXT)) == 0 && value[12] == 0xff && value[13] == 0xff, "read beyond the serial register");
+
+        fixture.report("overflow");
+    }
+
+    void test_faults()
+    {
+        static const uint32_t FREQUENCIES[] = {100000, 400000, 1000000};
+        static const uint32_t STRETCH_US = 20;
+        static const uint32_t TRANSACTIONS = 50;
+
+        uint8_t value[12];
+        memcpy(value, TEXT, sizeof(value));
+
+        /* bus speed and clock stretching, 14 acknowledged bytes per transaction */
+        for (const uint32_t frequency : FREQUENCIES)
+        {
+            for (const uint32_t stretch : {0u, STRETCH_US})
+            {
+                Fixture fixture(frequency, stretch);
+                for (uint32_t i = 0; i < TRANSACTIONS; ++i)
+                {
+                    value[0] = static_cast<uint8_t>(i);
+                    TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{value, sizeof(value)}) == status_t::DONE, "write failed");
+                }
+
+                char name[32];
+                snprintf(name, sizeof(name), "%4u kHz stretch %2u us", frequency / 1000, stretch);
+                const uint32_t utilization = fixture.report(name);
+
+                const uint64_t bits = TRANSACTIONS * (1 + 9 + 9 * 13 + 1);
+                const uint64_t expected = TRANSACTIONS * 14 * stretch + (bits * 1000000 + TRANSACTIONS * (frequency - 1)) / frequency;
+                TEST_ASSERT_MESSAGE(fixture.bus.get_stretch_us() == TRANSACTIONS * 14 * stretch, "stretch time");
+                TEST_ASSERT_MESSAGE(fixture.bus.get_busy_us() <= expected && fixture.bus.get_busy_us() + TRANSACTIONS >= expected, "bus time");
+                TEST_ASSERT_MESSAGE(utilization >= 50, "master leaves the bus idle");
+            }
+        }
+
+        /* NAK injection, the bytes before the NAK reach the slave */
+        Fixture fixture(400000);
+        memcpy(value, TEXT, sizeof(value));
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{value, sizeof(value)}) == status_t::DONE, "write failed");
+
+        uint8_t changed[12];
+        memset(changed, 0x77, sizeof(changed));
+        fixture.bus.inject_nack(TARGET, 5);
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{changed, sizeof(changed)}) == status_t::NACK, "injected data NAK ignored");
+
+        uint8_t serial[12];
+        fixture.bank.fetch(2, serial);
+        TEST_ASSERT_MESSAGE(memcmp(serial, changed, 3) == 0 && memcmp(&serial[3], &TEXT[3], 9) == 0, "bytes before the NAK");
+
+        const uint32_t notifications = fixture.bank.get_notifications();
+        fixture.bus.inject_nack(TARGET, 0);
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{value, sizeof(value)}) == status_t::NACK, "injected address NAK ignored");
+        TEST_ASSERT_MESSAGE(fixture.bank.get_notifications() == notifications, "NAKed address reached the slave");
+
+        TEST_ASSERT_MESSAGE(fixture.write(SERIAL, chunk_t{value, sizeof(value)}) == status_t::DONE, "NAK injected twice");
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, serial) && memcmp(serial, TEXT, sizeof(serial)) == 0, "write after NAK");
+
+        fixture.report("nak injection");
+    }
+
+    void test_burst()
+    {
+        Fixture fixture(400000);
+        calls = 0;
+        fixture.bank.set_handler(handler);
+
+        uint8_t id[] = {0xde, 0xad};
+        uint8_t control[] = {0x01, 0x02};
+        uint8_t serial[] = {0x11, 0x22, 0x33};
+        const core::driver::i2c::register_write_t list[] = {
+            {0x02, {id, sizeof(id)}},
+            {0x04, {control, sizeof(control)}},
+            {0x14, {serial, sizeof(serial)}},
+        };
+
+        /* 0x02 and 0x04 are adjacent, 0x14 needs a repeated start */
+        core::driver::i2c::Burst burst;
+        transaction_t *const transaction = burst.prepare(TARGET, list, 3, nullptr);
+        TEST_ASSERT_MESSAGE(transaction && burst.get_links() == 2, "wrong chain");
+        TEST_ASSERT_MESSAGE(fixture.run(transaction) == status_t::DONE, "burst failed");
+
+        /* the repeated start does not end the transaction, one notification at STOP */
+        TEST_ASSERT_MESSAGE(calls == 1 && fixture.bank.get_notifications() == 1, "notified at a repeated start");
+        TEST_ASSERT_MESSAGE(last.size() == 3, "wrong change set");
+
+        uint8_t value[12] = {};
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(0, value) && value[2] == 0xde && value[3] == 0xad, "id differs");
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(1, value) && value[0] == 0x01 && value[1] == 0x02, "control differs");
+        TEST_ASSERT_MESSAGE(fixture.bank.fetch(2, value) && value[4] == 0x11 && value[6] == 0x33, "serial differs");
+
+        fixture.report("burst");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"i2c loopback initialize", test_initialize},
+        {"i2c loopback write", test_write},
+        {"i2c loopback read", test_read},
+        {"i2c loopback text", test_text},
+        {"i2c loopback unknown", test_unknown},
+        {"i2c loopback overflow", test_overflow},
+        {"i2c loopback faults", test_faults},
+        {"i2c loopback burst", test_burst},
+    };
+    return test::host::run(CASES);
+}
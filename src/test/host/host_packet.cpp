@@ -0,0 +1,188 @@
+/**
+ * \file host_packet.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "packet.hpp"
+#include "spscring.hpp"
+#include "test_host.hpp"
+
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+
+namespace
+{
+    void test_round_trip()
+    {
+        static const size_t SIZES[] = {0, 1, 7, 253, 254, 255, 300, 600};
+        static uint8_t space[1024];
+        static uint8_t data[600];
+
+        spscring_t ring;
+        spscring_span_t payload;
+        core::packet::Receiver receiver;
+
+        spscring_init(&ring, chunk_t{space, sizeof(space)});
+
+        /* the ring position moves with every frame, so frames wrap at any offset */
+        for (size_t round = 0; round < 16; ++round)
+        {
+            for (const size_t size : SIZES)
+            {
+                /* zeros and long non zero runs exercise every code length */
+                for (size_t i = 0; i < size; ++i)
+                {
+                    data[i] = (round & 1) ? static_cast<uint8_t>(i % 5 ? i + round : 0) : static_cast<uint8_t>(0x80 | i);
+                }
+
+                const chunk_t message = {data, size};
+                TEST_ASSERT_MESSAGE(core::packet::transmit(&ring, &message), "packet does not fit");
+                TEST_ASSERT_MESSAGE(receiver.receive(&ring, &payload), "packet not received");
+
+                TEST_ASSERT_MESSAGE(payload.piece[0].size + payload.piece[1].size == size, "wrong payload size");
+                TEST_ASSERT_MESSAGE(memcmp(payload.piece[0].space, data, payload.piece[0].size) == 0, "wrong payload");
+                TEST_ASSERT_MESSAGE(memcmp(payload.piece[1].space, data + payload.piece[0].size, payload.piece[1].size) == 0, "wrong payload");
+
+                receiver.release(&ring);
+                TEST_ASSERT_MESSAGE(spscring_is_empty(&ring), "frame not consumed");
+            }
+        }
+
+        TEST_ASSERT_MESSAGE(receiver.get_packets() == 16 * sizeof(SIZES) / sizeof(SIZES[0]) && receiver.get_errors() == 0, "wrong packet count");
+    }
+
+    void test_frame_size()
+    {
+        static uint8_t space[1024];
+        static uint8_t data[600];
+        spscring_t ring;
+
+        static const size_t SIZES[] = {0, 1, 252, 253, 254, 508, 600};
+        memset(data, 0x11, sizeof(data));
+        for (const size_t size : SIZES)
+        {
+            spscring_init(&ring, chunk_t{space, sizeof(space)});
+            const chunk_t message = {data, size};
+            TEST_ASSERT_MESSAGE(core::packet::transmit(&ring, &message), "packet does not fit");
+            TEST_ASSERT_MESSAGE(spscring_count(&ring) <= core::packet::frame_size(size), "frame larger than frame_size()");
+        }
+
+        /* a frame that does not fit leaves the ring untouched */
+        uint8_t small[16];
+        spscring_init(&ring, chunk_t{small, sizeof(small)});
+        const chunk_t message = {data, 20};
+        TEST_ASSERT_MESSAGE(!core::packet::transmit(&ring, &message), "oversized frame accepted");
+        TEST_ASSERT_MESSAGE(spscring_is_empty(&ring), "oversized frame left bytes behind");
+    }
+
+    void test_damage()
+    {
+        static uint8_t space[256];
+        static uint8_t data[32];
+
+        spscring_t ring;
+        spscring_span_t payload;
+        spscring_span_t frame;
+        uint32_t errors = 0;
+
+        for (size_t i = 0; i < sizeof(data); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 3 + 1);
+        }
+
+        /* every byte of a frame damaged once, the following frame must survive */
+        for (size_t position = 0; position < core::packet::frame_size(sizeof(data)) - 1; ++position)
+        {
+            core::packet::Receiver receiver;
+            spscring_init(&ring, chunk_t{space, sizeof(space)});
+            const chunk_t message = {data, sizeof(data)};
+            core::packet::transmit(&ring, &message);
+
+            const size_t length = spscring_read_acquire(&ring, &frame);
+            if (position >= length - 1)
+            {
+                break;
+            }
+            frame.piece[0].space[position] ^= 0x10;
+            core::packet::transmit(&ring, &message);
+
+            bool intact = false;
+            while (receiver.receive(&ring, &payload))
+            {
+                intact = payload.piece[0].size == sizeof(data) && memcmp(payload.piece[0].space, data, sizeof(data)) == 0;
+                receiver.release(&ring);
+            }
+            TEST_ASSERT_MESSAGE(intact, "no resync after damaged frame");
+            errors += receiver.get_errors();
+        }
+        TEST_ASSERT_MESSAGE(errors > 0, "damaged frames not counted");
+
+        /* a partial frame waits for its delimiter, one without crc is dropped */
+        core::packet::Receiver receiver;
+        spscring_init(&ring, chunk_t{space, sizeof(space)});
+        spscring_push(&ring, 0x03);
+        spscring_push(&ring, 0x11);
+        TEST_ASSERT_MESSAGE(!receiver.receive(&ring, &payload), "incomplete frame received");
+        spscring_push(&ring, 0x22);
+        spscring_push(&ring, core::packet::DELIMITER);
+        TEST_ASSERT_MESSAGE(!receiver.receive(&ring, &payload), "frame without crc received");
+        TEST_ASSERT_MESSAGE(receiver.get_errors() == 1, "short frame not counted");
+    }
+
+    /* encode, ring and decode in one loop, the host counterpart of serial_packet_benchmark */
+    void test_throughput()
+    {
+        static const size_t SIZES[] = {16, 64, 256};
+        static const uint32_t PACKETS = 200000;
+        static uint8_t space[1024];
+        static uint8_t data[256];
+
+        spscring_t ring;
+        spscring_span_t payload;
+        core::packet::Receiver receiver;
+
+        for (size_t i = 0; i < sizeof(data); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        for (const size_t size : SIZES)
+        {
+            spscring_init(&ring, chunk_t{space, sizeof(space)});
+            const chunk_t message = {data, size};
+            const uint32_t before = receiver.get_packets();
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < PACKETS; ++i)
+            {
+                core::packet::transmit(&ring, &message);
+                receiver.receive(&ring, &payload);
+                receiver.release(&ring);
+            }
+            const uint64_t duration = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) + 1;
+
+            printf("packet throughput %3u bytes: %u packets/s, %u kbytes/s\n",
+                   static_cast<unsigned>(size),
+                   static_cast<unsigned>(PACKETS * 1000000ull / duration),
+                   static_cast<unsigned>(PACKETS * size * 1000ull / duration));
+            TEST_ASSERT_MESSAGE(receiver.get_packets() - before == PACKETS, "packets lost in the benchmark");
+        }
+
+        TEST_ASSERT_MESSAGE(receiver.get_errors() == 0, "packet errors in the benchmark");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"packet round trip", test_round_trip},
+        {"packet frame size", test_frame_size},
+        {"packet damage", test_damage},
+        {"packet throughput", test_throughput},
+    };
+    return test::host::run(CASES);
+}
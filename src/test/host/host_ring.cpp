@@ -0,0 +1,329 @@
+/**
+ * \file host_ring.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "checksum.hpp"
+#include "checksum_stream.hpp"
+#include "spscring.hpp"
+#include "test_host.hpp"
+
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+    namespace stress
+    {
+        /* 32M by default, the sanitizer builds pass a smaller count */
+#ifdef HOST_RING_STRESS_BYTES
+        static const uint32_t BYTES = HOST_RING_STRESS_BYTES;
+#else
+        static const uint32_t BYTES = 32000000;
+#endif
+        static const uint32_t BLOCK = 13;
+
+        static uint8_t space[256];
+        static spscring_t ring;
+
+        static uint8_t value(const uint32_t _index)
+        {
+            return static_cast<uint8_t>(_index ^ (_index >> 8) ^ (_index >> 16));
+        }
+
+        /* second thread, bytewise, block and span writes take turns */
+        static void producer()
+        {
+            uint8_t block[BLOCK];
+            uint32_t index = 0;
+
+            while (index < BYTES)
+            {
+                const uint32_t before = index;
+                switch ((index >> 10) % 3)
+                {
+                    case 0:
+                        index += spscring_push(&ring, value(index)) ? 1 : 0;
+                        break;
+                    case 1:
+                    {
+                        const uint32_t size = BYTES - index < BLOCK ? BYTES - index : BLOCK;
+                        for (uint32_t i = 0; i < size; ++i)
+                        {
+                            block[i] = value(index + i);
+                        }
+                        const chunk_t chunk = {block, size};
+                        index += static_cast<uint32_t>(spscring_write(&ring, &chunk));
+                        break;
+                    }
+                    default:
+                    {
+                        spscring_span_t span;
+                        spscring_write_acquire(&ring, &span);
+                        uint32_t written = 0;
+                        for (const chunk_t &piece : span.piece)
+                        {
+                            for (size_t i = 0; i < piece.size && index + written < BYTES && written < BLOCK; ++i)
+                            {
+                                piece.space[i] = value(index + written++);
+                            }
+                        }
+                        spscring_write_commit(&ring, written);
+                        index += written;
+                        break;
+                    }
+                }
+                if (index == before)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void test_init()
+    {
+        uint8_t space[64];
+        spscring_t ring;
+
+        TEST_ASSERT_MESSAGE(!spscring_init(&ring, chunk_t{space, 100}), "ring accepts a size which is no power of two");
+        TEST_ASSERT_MESSAGE(!spscring_init(&ring, chunk_t{nullptr, 64}), "ring accepts no memory");
+        TEST_ASSERT_MESSAGE(spscring_init(&ring, chunk_t{space, sizeof(space)}), "ring init failed");
+        TEST_ASSERT_MESSAGE(spscring_capacity(&ring) == sizeof(space) && spscring_is_empty(&ring), "wrong empty ring");
+    }
+
+    void test_push_pop()
+    {
+        uint8_t space[8];
+        spscring_t ring;
+        spscring_init(&ring, chunk_t{space, sizeof(space)});
+
+        /* several laps, the free running indices wrap inside the memory */
+        uint8_t next = 0;
+        uint8_t expected = 0;
+        for (int lap = 0; lap < 10; ++lap)
+        {
+            while (spscring_push(&ring, next))
+            {
+                next++;
+            }
+            TEST_ASSERT_MESSAGE(spscring_is_full(&ring) && spscring_space(&ring) == 0, "ring not full");
+
+            uint8_t value = 0;
+            for (int i = 0; i < 5; ++i)
+            {
+                TEST_ASSERT_MESSAGE(spscring_pop(&ring, &value) && value == expected++, "wrong order");
+            }
+            TEST_ASSERT_MESSAGE(spscring_count(&ring) == 3, "wrong count");
+            TEST_ASSERT_MESSAGE(spscring_peek(&ring, 2, &value) && value == static_cast<uint8_t>(expected + 2), "wrong peek");
+            TEST_ASSERT_MESSAGE(!spscring_peek(&ring, 3, &value), "peek beyond the content");
+        }
+
+        uint8_t value = 0;
+        while (spscring_pop(&ring, &value))
+        {
+            TEST_ASSERT_MESSAGE(value == expected++, "wrong order at the end");
+        }
+        TEST_ASSERT_MESSAGE(expected == next, "bytes lost");
+    }
+
+    void test_span()
+    {
+        uint8_t space[64];
+        uint8_t message[40];
+        spscring_t ring;
+        spscring_span_t span;
+
+        for (uint8_t i = 0; i < sizeof(message); ++i)
+        {
+            message[i] = static_cast<uint8_t>(0xa0 + i);
+        }
+
+        spscring_init(&ring, chunk_t{space, sizeof(space)});
+        spscring_write_commit(&ring, 50);
+        spscring_read_commit(&ring, 50);
+
+        TEST_ASSERT_MESSAGE(spscring_write_acquire(&ring, &span) == 64, "wrong writable size after wrap");
+        TEST_ASSERT_MESSAGE(span.piece[0].size == 14 && span.piece[1].size == 50, "wrong writable spans");
+        memcpy(span.piece[0].space, message, span.piece[0].size);
+        memcpy(span.piece[1].space, &message[span.piece[0].size], sizeof(message) - span.piece[0].size);
+        spscring_write_commit(&ring, sizeof(message));
+
+        TEST_ASSERT_MESSAGE(spscring_read_acquire(&ring, &span) == sizeof(message), "wrong readable size");
+        TEST_ASSERT_MESSAGE(span.piece[0].size == 14 && span.piece[1].size == 26, "wrong readable spans");
+
+        checksum_context_t crc;
+        checksum_init(&crc, CHECKSUM_STREAM_CRC, 0);
+        checksum_update_sequence(&crc, span.piece, 2);
+        const chunk_t whole = {message, sizeof(message)};
+        TEST_ASSERT_MESSAGE(checksum_finalize(&crc) == checksum_crc(&whole, 0), "span content differs");
+
+        spscring_read_commit(&ring, 20);
+        TEST_ASSERT_MESSAGE(spscring_read_acquire(&ring, &span) == 20, "wrong rest after partial commit");
+        TEST_ASSERT_MESSAGE(span.piece[0].space[0] == message[20] && span.piece[1].size == 0, "wrong rest span");
+
+        spscring_read_commit(&ring, 1000);
+        TEST_ASSERT_MESSAGE(spscring_is_empty(&ring), "read commit not clamped");
+        spscring_write_commit(&ring, 1000);
+        TEST_ASSERT_MESSAGE(spscring_is_full(&ring), "write commit not clamped");
+    }
+
+    void test_copy()
+    {
+        uint8_t space_a[64];
+        uint8_t space_b[32];
+        spscring_t source;
+        spscring_t destination;
+
+        /* every wrap position on both sides, destination partly filled */
+        for (size_t source_offset = 0; source_offset < sizeof(space_a); ++source_offset)
+        {
+            for (size_t destination_offset = 0; destination_offset < sizeof(space_b); ++destination_offset)
+            {
+                spscring_init(&source, chunk_t{space_a, sizeof(space_a)});
+                spscring_init(&destination, chunk_t{space_b, sizeof(space_b)});
+                spscring_write_commit(&source, source_offset);
+                spscring_read_commit(&source, source_offset);
+                spscring_write_commit(&destination, destination_offset);
+                spscring_read_commit(&destination, destination_offset);
+
+                const uint8_t busy = static_cast<uint8_t>(destination_offset % 7);
+                for (uint8_t i = 0; i < busy; ++i)
+                {
+                    spscring_push(&destination, 0xee);
+                }
+                for (uint8_t i = 0; i < 50; ++i)
+                {
+                    spscring_push(&source, i);
+                }
+
+                const size_t copied = spscring_copy(&source, &destination);
+                TEST_ASSERT_MESSAGE(copied == sizeof(space_b) - busy, "wrong copy size");
+                TEST_ASSERT_MESSAGE(spscring_count(&source) == 50 - copied, "wrong source rest");
+
+                uint8_t value = 0;
+                for (uint8_t i = 0; i < busy; ++i)
+                {
+                    spscring_pop(&destination, &value);
+                    TEST_ASSERT_MESSAGE(value == 0xee, "destination content overwritten");
+                }
+                for (uint8_t i = 0; i < copied; ++i)
+                {
+                    spscring_pop(&destination, &value);
+                    TEST_ASSERT_MESSAGE(value == i, "wrong copied content");
+                }
+            }
+        }
+    }
+
+    void test_statistics()
+    {
+        uint8_t space[8];
+        uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        spscring_t ring;
+        spscring_statistics_t statistics;
+
+        spscring_init(&ring, chunk_t{space, sizeof(space)});
+
+        const chunk_t message = {data, sizeof(data)};
+        spscring_write(&ring, &message);
+        spscring_push(&ring, 0xff);
+
+        chunk_t received = {data, 5};
+        spscring_read(&ring, &received);
+
+        uint8_t value;
+        while (spscring_pop(&ring, &value))
+        {
+        }
+
+        spscring_statistics(&ring, &statistics);
+#if SPSCRING_STATISTICS
+        TEST_ASSERT_MESSAGE(statistics.peak == 8 && statistics.overflows == 2 && statistics.rejected == 3, "wrong producer statistics");
+        TEST_ASSERT_MESSAGE(statistics.written == 8 && statistics.underruns == 1 && statistics.read == 8, "wrong consumer statistics");
+#else
+        TEST_ASSERT_MESSAGE(statistics.peak == 0 && statistics.written == 0, "statistics without SPSCRING_STATISTICS");
+#endif
+    }
+
+    /* producer and consumer on two threads, run it with HOST_SANITIZER=thread */
+    void test_stress()
+    {
+        TEST_ASSERT_MESSAGE(spscring_init(&stress::ring, chunk_t{stress::space, sizeof(stress::space)}), "ring init failed");
+
+        uint32_t received = 0;
+        uint32_t wrong = 0;
+        uint8_t block[stress::BLOCK + 4];
+
+        std::thread producer(stress::producer);
+
+        while (received < stress::BYTES)
+        {
+            const uint32_t before = received;
+            switch ((received >> 11) % 3)
+            {
+                case 0:
+                {
+                    uint8_t value;
+                    if (spscring_pop(&stress::ring, &value))
+                    {
+                        wrong += (value != stress::value(received++)) ? 1 : 0;
+                    }
+                    break;
+                }
+                case 1:
+                {
+                    chunk_t chunk = {block, sizeof(block)};
+                    const size_t size = spscring_read(&stress::ring, &chunk);
+                    for (size_t i = 0; i < size; ++i)
+                    {
+                        wrong += (block[i] != stress::value(received++)) ? 1 : 0;
+                    }
+                    break;
+                }
+                default:
+                {
+                    spscring_span_t span;
+                    const size_t count = spscring_read_acquire(&stress::ring, &span);
+                    for (const chunk_t &piece : span.piece)
+                    {
+                        for (size_t i = 0; i < piece.size; ++i)
+                        {
+                            wrong += (piece.space[i] != stress::value(received++)) ? 1 : 0;
+                        }
+                    }
+                    spscring_read_commit(&stress::ring, count);
+                    break;
+                }
+            }
+            if (received == before)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        producer.join();
+
+        printf("ring stress: %u bytes, %u wrong\n", received, wrong);
+        TEST_ASSERT_MESSAGE(received == stress::BYTES, "bytes lost");
+        TEST_ASSERT_MESSAGE(wrong == 0, "bytes duplicated or reordered");
+        TEST_ASSERT_MESSAGE(spscring_is_empty(&stress::ring), "bytes left in ring");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"ring init", test_init},
+        {"ring push pop", test_push_pop},
+        {"ring span", test_span},
+        {"ring copy", test_copy},
+        {"ring statistics", test_statistics},
+        {"ring stress", test_stress},
+    };
+    return test::host::run(CASES);
+}
@@ -0,0 +1,385 @@
+/**
+ * \file host_uart_sim.cpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "spscring.hpp"
+#include "test_host.hpp"
+#include "uart_negotiation.hpp"
+#include "uart_sim.hpp"
+
+#include <initializer_list>
+#include <stdint.h>
+
+namespace
+{
+    using core::driver::uart::SimulatedDevice;
+
+    static const uint32_t BAUDRATE = 115200;
+    static const uint64_t STEP_US = 5;
+    static const uint64_t DURATION_US = 200000;
+    static const size_t SIZE = 256;
+    static const core::driver::uart::dispatch_t DISPATCH = {16, core::driver::uart::NO_DELIMITER, 200};
+
+    static uint8_t first_rx[SIZE];
+    static uint8_t second_rx[SIZE];
+    static uint8_t first_tx[SIZE];
+    static uint8_t second_tx[SIZE];
+
+    static uint64_t now = 0;
+    static uint32_t received = 0;
+    static uint32_t wrong = 0;
+
+    static uint64_t clock()
+    {
+        return now;
+    }
+
+    static uint8_t value(const uint32_t _index)
+    {
+        return static_cast<uint8_t>(_index ^ (_index >> 8));
+    }
+
+    static void echo(spscring_t *const _rx, spscring_t *const _tx)
+    {
+        spscring_copy(_rx, _tx);
+    }
+
+    static void check(spscring_t *const _rx, spscring_t *const)
+    {
+        spscring_span_t span;
+        const size_t count = spscring_read_acquire(_rx, &span);
+        for (const chunk_t &piece : span.piece)
+        {
+            for (size_t i = 0; i < piece.size; ++i)
+            {
+                wrong += (piece.space[i] != value(received++)) ? 1 : 0;
+            }
+        }
+        spscring_read_commit(_rx, count);
+    }
+
+    static void drop(spscring_t *const _rx, spscring_t *const)
+    {
+        received += static_cast<uint32_t>(spscring_count(_rx));
+        spscring_read_commit(_rx, spscring_count(_rx));
+    }
+
+    /* takes one byte every fourth call, slower than the line */
+    static void slow(spscring_t *const _rx, spscring_t *const)
+    {
+        static uint32_t calls = 0;
+        uint8_t byte;
+        if ((++calls & 3) == 0 && spscring_pop(_rx, &byte))
+        {
+            received++;
+        }
+    }
+
+    static uint32_t counted[2] = {0, 0};
+
+    template <size_t INDEX>
+    static void count(spscring_t *const _rx, spscring_t *const)
+    {
+        counted[INDEX] += static_cast<uint32_t>(spscring_count(_rx));
+        spscring_read_commit(_rx, spscring_count(_rx));
+    }
+
+    /* handler latency: arrival of the oldest unhandled byte to the handler call */
+    static uint32_t latency_avg(const core::driver::uart::sim_statistics_t &_statistics)
+    {
+        return static_cast<uint32_t>(_statistics.latency_count ? _statistics.latency_sum / _statistics.latency_count : 0);
+    }
+
+    static void report(const char *const _name, const SimulatedDevice &_device)
+    {
+        const core::driver::uart::sim_statistics_t &statistics = _device.get_statistics();
+        printf("uart sim %s: %u delivered %u lost, line %u bytes/s, latency avg %u max %u us\n",
+               _name,
+               statistics.delivered,
+               statistics.lost,
+               static_cast<uint32_t>(static_cast<uint64_t>(statistics.delivered) * 1000000 / DURATION_US),
+               latency_avg(statistics),
+               statistics.latency_max);
+    }
+
+    /* on a busy line the threshold fires: the oldest byte waits for at most _bytes byte times, give or take one step */
+    static bool latency_bounded(const SimulatedDevice &_device, const uint64_t _bytes)
+    {
+        const core::driver::uart::sim_statistics_t &statistics = _device.get_statistics();
+        const uint64_t bound = _bytes * 10 * 1000000 / BAUDRATE + STEP_US;
+        return statistics.latency_count > 0 && statistics.latency_max <= bound;
+    }
+
+    SimulatedDevice::config_t config(const uint32_t _loss_ppm,
+                                     const uint32_t _seed,
+                                     uint8_t *const _rx,
+                                     uint8_t *const _tx,
+                                     const bool _flow_control = false,
+                                     const uint32_t _baudrate = BAUDRATE)
+    {
+        return SimulatedDevice::config_t{_baudrate, _loss_ppm, _seed, clock, DISPATCH, chunk_t{_rx, SIZE}, chunk_t{_tx, SIZE}, nullptr, _flow_control};
+    }
+
+    void test_echo()
+    {
+        SimulatedDevice first(config(0, 1, first_rx, first_tx));
+        SimulatedDevice second(config(0, 2, second_rx, second_tx));
+        first.connect(second);
+        first.set_handler(check);
+        second.set_handler(echo);
+
+        now = 0;
+        received = 0;
+        wrong = 0;
+        first.initialize();
+        second.initialize();
+
+        uint32_t sent = 0;
+        for (; now < DURATION_US; now += STEP_US)
+        {
+            while (spscring_push(first.get_tx(), value(sent)))
+            {
+                sent++;
+            }
+            second.perform();
+            first.perform();
+        }
+
+        const uint32_t line = static_cast<uint32_t>(static_cast<uint64_t>(first.get_statistics().delivered) * 1000000 / DURATION_US);
+        printf("uart sim echo: %u sent %u received\n", sent, received);
+        report("echo", second);
+        report("back", first);
+
+        first.shutdown();
+        second.shutdown();
+
+        TEST_ASSERT_MESSAGE(wrong == 0, "bytes corrupted");
+        TEST_ASSERT_MESSAGE(first.get_statistics().lost + second.get_statistics().lost == 0, "bytes lost without loss injection");
+        TEST_ASSERT_MESSAGE(line > BAUDRATE / 10 * 9 / 10 && line <= BAUDRATE / 10, "not at line rate");
+        TEST_ASSERT_MESSAGE(latency_bounded(first, DISPATCH.threshold) && latency_bounded(second, DISPATCH.threshold), "handler latency beyond the threshold");
+    }
+
+    /* both directions at once, each with loss injection */
+    void test_cross()
+    {
+        static const uint32_t LOSS_PPM = 10000;
+
+        SimulatedDevice first(config(LOSS_PPM, 1, first_rx, first_tx));
+        SimulatedDevice second(config(LOSS_PPM, 2, second_rx, second_tx));
+        first.connect(second);
+        first.set_handler(count<0>);
+        second.set_handler(count<1>);
+
+        now = 0;
+        counted[0] = 0;
+        counted[1] = 0;
+        first.initialize();
+        second.initialize();
+
+        for (; now < DURATION_US; now += STEP_US)
+        {
+            while (spscring_push(first.get_tx(), 0x55))
+            {
+            }
+            while (spscring_push(second.get_tx(), 0xaa))
+            {
+            }
+            second.perform();
+            first.perform();
+        }
+
+        report("cross first", first);
+        report("cross second", second);
+
+        first.shutdown();
+        second.shutdown();
+
+        for (const SimulatedDevice *device : {&first, &second})
+        {
+            const core::driver::uart::sim_statistics_t &statistics = device->get_statistics();
+            const uint32_t total = statistics.delivered + statistics.lost;
+
+            TEST_ASSERT_MESSAGE(statistics.overflows == 0, "receiver overflow");
+            TEST_ASSERT_MESSAGE(statistics.lost > total / 200 && statistics.lost < total / 50, "loss rate out of range");
+            /* a lost byte is waited for as well */
+            TEST_ASSERT_MESSAGE(latency_bounded(*device, 2 * DISPATCH.threshold), "handler latency beyond the threshold");
+        }
+        TEST_ASSERT_MESSAGE(first.get_statistics().sent == second.get_statistics().delivered + second.get_statistics().lost, "bytes vanished");
+        TEST_ASSERT_MESSAGE(counted[0] + spscring_count(first.get_rx()) == first.get_statistics().delivered, "handler missed bytes");
+        TEST_ASSERT_MESSAGE(counted[1] + spscring_count(second.get_rx()) == second.get_statistics().delivered, "handler missed bytes");
+    }
+
+    void test_loss()
+    {
+        static const uint32_t LOSS_PPM = 10000;
+
+        SimulatedDevice first(config(LOSS_PPM, 1, first_rx, first_tx));
+        SimulatedDevice second(config(LOSS_PPM, 2, second_rx, second_tx));
+        first.connect(second);
+        second.set_handler(drop);
+
+        now = 0;
+        received = 0;
+        first.initialize();
+        second.initialize();
+
+        for (; now < DURATION_US; now += STEP_US)
+        {
+            while (spscring_push(first.get_tx(), 0x55))
+            {
+            }
+            second.perform();
+            first.perform();
+        }
+
+        const core::driver::uart::sim_statistics_t &statistics = second.get_statistics();
+        const uint32_t total = statistics.delivered + statistics.lost;
+        printf("uart sim loss: %u delivered %u lost\n", statistics.delivered, statistics.lost);
+
+        TEST_ASSERT_MESSAGE(statistics.overflows == 0, "receiver overflow");
+        TEST_ASSERT_MESSAGE(statistics.lost > total / 200 && statistics.lost < total / 50, "loss rate out of range");
+        TEST_ASSERT_MESSAGE(first.get_statistics().sent == total, "bytes vanished");
+        TEST_ASSERT_MESSAGE(received + spscring_count(second.get_rx()) == statistics.delivered, "handler missed bytes");
+    }
+
+    void test_flow_control()
+    {
+        for (const bool flow_control : {false, true})
+        {
+            /* the line is faster than the consumer */
+            SimulatedDevice first(config(0, 1, first_rx, first_tx, flow_control, 921600));
+            SimulatedDevice second(config(0, 2, second_rx, second_tx, flow_control, 921600));
+            first.connect(second);
+            second.set_handler(slow);
+
+            now = 0;
+            received = 0;
+            first.initialize();
+            second.initialize();
+
+            uint32_t sent = 0;
+            for (; now < 50000; now += STEP_US)
+            {
+                while (sent < 4000 && spscring_push(first.get_tx(), 0x5a))
+                {
+                    sent++;
+                }
+                first.perform();
+                second.perform();
+            }
+
+            const size_t in_flight = spscring_count(first.get_tx()) + spscring_count(second.get_rx());
+            printf("uart sim flow control %s: %u sent %u received %u overflows\n", flow_control ? "on" : "off", sent, received, second.get_overflows());
+
+            TEST_ASSERT_MESSAGE(flow_control ? second.get_overflows() == 0 : second.get_overflows() > 0, "flow control has no effect");
+            TEST_ASSERT_MESSAGE(received + second.get_statistics().lost + second.get_overflows() + in_flight == sent, "bytes vanished");
+        }
+    }
+
+    void test_negotiation()
+    {
+        static const uint32_t DEFAULT_RATE = 115200;
+        static const uint32_t FIRST_RATES[] = {460800, 921600, 3000000};
+        static const uint32_t SECOND_RATES[] = {460800, 921600};
+        using core::driver::uart::negotiation_t;
+        using Negotiator = core::driver::uart::Negotiator<SimulatedDevice>;
+
+        SimulatedDevice first(config(0, 1, first_rx, first_tx));
+        SimulatedDevice second(config(0, 2, second_rx, second_tx));
+        first.connect(second);
+
+        now = 0;
+        first.initialize();
+        second.initialize();
+
+        Negotiator a(first, {FIRST_RATES, 3, DEFAULT_RATE, 5000, 50000, 3, 10, clock});
+        Negotiator b(second, {SECOND_RATES, 2, DEFAULT_RATE, 5000, 50000, 3, 10, clock});
+        a.start();
+        b.start();
+        for (const uint64_t end = now + 500000; now < end && !(a.is_done() && b.is_done()); now += STEP_US)
+        {
+            first.perform();
+            second.perform();
+            a.perform();
+            b.perform();
+        }
+
+        printf("uart sim negotiation: %u/%u baud after %u us\n", a.get_rate(), b.get_rate(), static_cast<uint32_t>(now));
+        TEST_ASSERT_MESSAGE(a.get_state() == negotiation_t::LINKED && b.get_state() == negotiation_t::LINKED, "link not established");
+        TEST_ASSERT_MESSAGE(a.get_rate() == 921600 && b.get_rate() == 921600, "not the fastest common rate");
+        TEST_ASSERT_MESSAGE(first.get_baudrate() == 921600 && second.get_baudrate() == 921600, "devices not switched");
+
+        /* one end falls back, the other one sees garbled traffic and follows */
+        TEST_ASSERT_MESSAGE(!a.supervise(first.get_errors()) && !b.supervise(second.get_errors()), "fall back on a clean link");
+        TEST_ASSERT_MESSAGE(a.supervise(first.get_errors() + 11), "no fall back above the error limit");
+        TEST_ASSERT_MESSAGE(first.get_baudrate() == DEFAULT_RATE && second.get_baudrate() == 921600, "not a one sided fall back");
+
+        bool followed = false;
+        for (const uint64_t end = now + 50000; now < end && !followed; now += STEP_US)
+        {
+            spscring_push(first.get_tx(), 0x55);
+            first.perform();
+            second.perform();
+            spscring_read_commit(second.get_rx(), spscring_count(second.get_rx()));
+            followed = b.supervise(second.get_errors());
+        }
+
+        printf("uart sim negotiation: %u/%u baud after %u framing errors\n", a.get_rate(), b.get_rate(), second.get_errors());
+        TEST_ASSERT_MESSAGE(followed && b.get_state() == negotiation_t::FALLBACK, "peer stays at the fast rate");
+        TEST_ASSERT_MESSAGE(first.get_baudrate() == DEFAULT_RATE && second.get_baudrate() == DEFAULT_RATE, "not back at the default rate");
+    }
+
+    void test_accept_mismatch()
+    {
+        static const uint32_t DEFAULT_RATE = 115200;
+        static const uint32_t RATES[] = {460800, 921600};
+        using core::driver::uart::negotiation_t;
+        using Negotiator = core::driver::uart::Negotiator<SimulatedDevice>;
+
+        SimulatedDevice first(config(0, 1, first_rx, first_tx));
+        SimulatedDevice second(config(0, 2, second_rx, second_tx));
+        first.connect(second);
+
+        now = 0;
+        first.initialize();
+        second.initialize();
+
+        /* a stale ACCEPT of another rate is in the ring before the round starts */
+        uint8_t stale[5] = {'A', 0x00, 0x08, 0x07, 0x00};
+        const chunk_t chunk = {stale, sizeof(stale)};
+        core::packet::transmit(second.get_tx(), &chunk);
+
+        Negotiator a(first, {RATES, 2, DEFAULT_RATE, 5000, 50000, 3, 10, clock});
+        Negotiator b(second, {RATES, 2, DEFAULT_RATE, 5000, 50000, 3, 10, clock});
+        a.start();
+        b.start();
+        for (const uint64_t end = now + 500000; now < end && !(a.is_done() && b.is_done()); now += STEP_US)
+        {
+            first.perform();
+            second.perform();
+            a.perform();
+            b.perform();
+        }
+
+        printf("uart sim negotiation: %u/%u baud after a stale accept\n", a.get_rate(), b.get_rate());
+        TEST_ASSERT_MESSAGE(a.get_state() == negotiation_t::LINKED && b.get_state() == negotiation_t::LINKED, "link not established");
+        TEST_ASSERT_MESSAGE(first.get_baudrate() == 921600 && second.get_baudrate() == 921600, "switched on the stale rate");
+    }
+}
+
+int main()
+{
+    static const test::host::case_t CASES[] = {
+        {"uart sim echo", test_echo},
+        {"uart sim cross", test_cross},
+        {"uart sim loss", test_loss},
+        {"uart sim flow control", test_flow_control},
+        {"uart sim negotiation", test_negotiation},
+        {"uart sim accept mismatch", test_accept_mismatch},
+    };
+    return test::host::run(CASES);
+}
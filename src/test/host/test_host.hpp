@@ -0,0 +1,44 @@
+/**
+ * \file test_host.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* unity stand-in: the first failed assertion ends the executable, ctest sees the exit code */
+#define TEST_ASSERT_MESSAGE(_condition, _message)                                 \
+    do                                                                            \
+    {                                                                             \
+        if (!(_condition))                                                        \
+        {                                                                         \
+            printf("%s:%d: FAIL: %s\n", __FILE__, __LINE__, _message);            \
+            exit(EXIT_FAILURE);                                                   \
+        }                                                                         \
+    } while (0)
+
+namespace test::host
+{
+    struct case_t
+    {
+        const char *name;
+        void (*run)();
+    };
+
+    template <size_t COUNT>
+    int run(const case_t (&_cases)[COUNT])
+    {
+        for (const case_t &test : _cases)
+        {
+            printf("%s\n", test.name);
+            test.run();
+        }
+        printf("%u tests passed\n", static_cast<unsigned>(COUNT));
+        return EXIT_SUCCESS;
+    }
+}
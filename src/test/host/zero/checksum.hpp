@@ -0,0 +1,64 @@
+/**
+ * \file checksum.hpp
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "chunk.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    host stand-in for the zero checksum functions the peach checksum
+    modules fall back on, bitwise and with the same polynomials as the
+    crc engine (0x1021, reflected 0x8408)
+*/
+
+static inline uint16_t checksum_sum(const chunk_t *const _chunk, const uint16_t _sum)
+{
+    uint16_t sum = _sum;
+    for (size_t i = 0; i < _chunk->size; ++i)
+    {
+        sum = static_cast<uint16_t>(sum + _chunk->space[i]);
+    }
+    return sum;
+}
+
+static inline uint16_t checksum_crc_byte(const uint8_t _value, const uint16_t _crc)
+{
+    uint16_t crc = static_cast<uint16_t>(_crc ^ (_value << 8));
+    for (int bit = 0; bit < 8; ++bit)
+    {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+    return crc;
+}
+
+static inline uint16_t checksum_crc(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    for (size_t i = 0; i < _chunk->size; ++i)
+    {
+        crc = checksum_crc_byte(_chunk->space[i], crc);
+    }
+    return crc;
+}
+
+static inline uint16_t checksum_crc_reflected(const chunk_t *const _chunk, const uint16_t _crc)
+{
+    uint16_t crc = _crc;
+    for (size_t i = 0; i < _chunk->size; ++i)
+    {
+        crc = static_cast<uint16_t>(crc ^ _chunk->space[i]);
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0x8408) : static_cast<uint16_t>(crc >> 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,19 @@
+/**
+ * \file chunk.h
+ * \author Koch, Roman (koch.roman@googlemail.com)
+ *
+ * Copyright (c) 2024, Roman Koch, koch.roman@gmail.com
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* host stand-in for the zero chunk, same layout */
+typedef struct
+{
+    uint8_t *space;
+    size_t size;
+} chunk_t;